@@ -0,0 +1,547 @@
+/**
+ * @file    Assets.cpp
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'cardgen' is a playing card image generator.
+ *
+ * Implementation for the Assets class.
+ */
+
+#include <arpa/inet.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "cardgen.h"
+#include "Assets.h"
+#include "Hash.h"
+
+
+/**
+ * @section Persistent index file format.
+ *
+ * The index is a header followed by an array of directory records sorted by
+ * path, an array of file records grouped by directory and sorted by name,
+ * and a table of the strings they refer to. All records have fixed sizes so
+ * the file can be used directly from a read-only memory mapping.
+ */
+
+struct Assets::Header
+{
+    char magic[8];
+    uint32_t directoryCount;
+    uint32_t fileCount;
+    uint32_t stringBytes;
+    uint32_t reserved;
+};
+
+struct Assets::DirectoryRecord
+{
+    int64_t mtime;
+    uint32_t pathOffset;
+    uint32_t pathLength;
+    uint32_t firstFile;
+    uint32_t fileCount;
+};
+
+struct Assets::FileRecord
+{
+    uint64_t size;
+    int64_t mtime;
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    int32_t width;
+    int32_t height;
+    uint8_t hash[32];
+};
+
+static const char magic[8]{ 'C', 'G', 'I', 'D', 'X', '0', '0', '1' };
+
+
+/**
+ * @section Internal constants and variables.
+ *
+ */
+
+std::mutex Assets::mutex{};
+std::map<std::string, Assets::Directory> Assets::directories{};
+
+const Assets::Header * Assets::index{};
+size_t Assets::indexSize{};
+
+
+/**
+ * @section Internal support code.
+ *
+ */
+
+/**
+ * Get the modification time of a file in nanoseconds.
+ *
+ * @param  st - file status.
+ * @return the modification time.
+ */
+static int64_t getMtime(const struct stat & st)
+{
+    return (int64_t(st.st_mtim.tv_sec) * 1000000000) + st.st_mtim.tv_nsec;
+}
+
+
+/**
+ * @section Assets class method code.
+ *
+ */
+
+/**
+ * Check validity of the .png file.
+ *
+ * @param  buffer - raw bytes of the image file.
+ * @return true if valid, false otherwise.
+ */
+bool Assets::isValidPNG(const char * const buffer)
+{
+    const uint8_t magic[] = { 0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A };
+    for (int i{}; i < sizeof(magic); ++i)
+    {
+        if ((uint8_t)buffer[i] != magic[i])
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * Check if a range lies within a table.
+ *
+ * @param  offset - start of the range.
+ * @param  length - length of the range.
+ * @param  limit - size of the table.
+ * @return true if the range is inside, false otherwise.
+ */
+static bool isInside(uint32_t offset, uint32_t length, uint32_t limit)
+{
+    return uint64_t(offset) + length <= limit;
+}
+
+/**
+ * Check that every record of a mapped index refers only to files and
+ * strings within the index, so that a damaged index can't be followed
+ * outside the mapping. The size of the index has already been checked.
+ *
+ * @param  header - header of the mapped index.
+ * @return true if the records are consistent, false otherwise.
+ */
+bool Assets::isConsistent(const Header * header)
+{
+    const DirectoryRecord * records{reinterpret_cast<const DirectoryRecord *>(header + 1)};
+    for (uint32_t i{}; i < header->directoryCount; ++i)
+        if ((!isInside(records[i].pathOffset, records[i].pathLength, header->stringBytes)) ||
+            (!isInside(records[i].firstFile, records[i].fileCount, header->fileCount)))
+            return false;
+
+    const FileRecord * files{reinterpret_cast<const FileRecord *>(records + header->directoryCount)};
+    for (uint32_t i{}; i < header->fileCount; ++i)
+        if (!isInside(files[i].nameOffset, files[i].nameLength, header->stringBytes))
+            return false;
+
+    return true;
+}
+
+/**
+ * Map the persistent index into memory, if there is one. This is only
+ * attempted once.
+ *
+ * @return true if the index is available, false otherwise.
+ */
+bool Assets::loadIndex(void)
+{
+    static bool tried{};
+    if (tried)
+        return index != nullptr;
+
+    tried = true;
+
+    const int fd{open(_assetIndexFilename.c_str(), O_RDONLY|O_CLOEXEC)};
+    if (fd < 0)
+        return false;
+
+    struct stat st{};
+    void * map{MAP_FAILED};
+    if ((fstat(fd, &st) == 0) && (size_t(st.st_size) >= sizeof(Header)))
+        map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (map == MAP_FAILED)
+        return false;
+
+    // Check the index is complete and consistent before using it.
+    const Header * header{static_cast<const Header *>(map)};
+    const uint64_t size{sizeof(Header) + (uint64_t(header->directoryCount) * sizeof(DirectoryRecord)) +
+        (uint64_t(header->fileCount) * sizeof(FileRecord)) + header->stringBytes};
+    if ((std::memcmp(header->magic, magic, sizeof(magic))) || (size != uint64_t(st.st_size)) || (!isConsistent(header)))
+    {
+        munmap(map, st.st_size);
+        std::cerr << "Ignoring invalid asset index " << _assetIndexFilename << "\n";
+
+        return false;
+    }
+
+    index = header;
+    indexSize = st.st_size;
+
+    return true;
+}
+
+/**
+ * Get a string from the string table of the index.
+ *
+ * @param  offset - offset of the string in the table.
+ * @return the string.
+ */
+const char * Assets::getString(uint32_t offset)
+{
+    const char * base{reinterpret_cast<const char *>(index + 1)};
+    base += (index->directoryCount * sizeof(DirectoryRecord)) + (size_t(index->fileCount) * sizeof(FileRecord));
+
+    return base + offset;
+}
+
+/**
+ * Find the record for a directory in the index.
+ *
+ * @param  directory - name of directory.
+ * @return the directory record, or nullptr if not indexed.
+ */
+const Assets::DirectoryRecord * Assets::findDirectory(const std::string & directory)
+{
+    if (!loadIndex())
+        return nullptr;
+
+    const DirectoryRecord * first{reinterpret_cast<const DirectoryRecord *>(index + 1)};
+    const DirectoryRecord * last{first + index->directoryCount};
+    auto less = [](const DirectoryRecord & record, const std::string & value)
+        { return std::string_view{getString(record.pathOffset), record.pathLength} < value; };
+
+    const DirectoryRecord * it{std::lower_bound(first, last, directory, less)};
+    if ((it == last) || (std::string_view{getString(it->pathOffset), it->pathLength} != directory))
+        return nullptr;
+
+    return it;
+}
+
+/**
+ * Check if an indexed file is unchanged since the index was built.
+ *
+ * @param  fileName - name of file.
+ * @param  record - index record for the file.
+ * @return true if the record is current, false otherwise.
+ */
+bool Assets::isCurrent(const std::string & fileName, const FileRecord * record)
+{
+    struct stat st{};
+    if (stat(fileName.c_str(), &st))
+        return false;
+
+    return (uint64_t(st.st_size) == record->size) && (getMtime(st) == record->mtime);
+}
+
+/**
+ * Get the table for a directory on first use. If the directory is indexed
+ * and unchanged the table comes from the index, otherwise it is listed.
+ *
+ * @param  directory - name of directory.
+ * @return the table of files in the directory.
+ */
+Assets::Directory & Assets::scan(const std::string & directory)
+{
+    auto it{directories.find(directory)};
+    if (it != directories.end())
+        return it->second;
+
+    Directory & table{directories[directory]};
+    const std::string path{directory.empty() ? "." : directory};
+
+    const DirectoryRecord * record{findDirectory(path)};
+    struct stat st{};
+    if ((record) && (stat(path.c_str(), &st) == 0) && (getMtime(st) == record->mtime))
+    {
+        const FileRecord * files{reinterpret_cast<const FileRecord *>(reinterpret_cast<const DirectoryRecord *>(index + 1) + index->directoryCount)};
+        for (uint32_t i{}; i < record->fileCount; ++i)
+        {
+            const FileRecord * file{files + record->firstFile + i};
+            table[std::string{getString(file->nameOffset), file->nameLength}] = Entry{ false, false, 0, 0, file };
+        }
+
+        return table;
+    }
+
+    std::error_code ec{};
+    for (const auto & entry : std::filesystem::directory_iterator{path, ec})
+        table[entry.path().filename().string()] = Entry{};
+
+    return table;
+}
+
+/**
+ * Read the size of the image from the header of a png file, or from the
+ * index if the file is unchanged.
+ *
+ * @param  fileName - name of image file.
+ * @param  entry - table entry to populate.
+ */
+void Assets::readHeader(const std::string & fileName, Entry & entry)
+{
+    entry.read = true;
+
+    if (entry.record)
+    {
+        if (isCurrent(fileName, entry.record))
+        {
+            entry.valid = entry.record->width > 0;
+            entry.width = entry.record->width;
+            entry.height = entry.record->height;
+
+            return;
+        }
+
+        entry.record = nullptr;
+    }
+
+    std::ifstream file{fileName, std::ifstream::in|std::ifstream::binary};
+    if (!file.is_open())
+        return;
+
+    char buffer[28]{};
+    file.read(buffer, 24);
+    if ((file) && (isValidPNG(buffer)))
+    {
+        entry.valid = true;
+        entry.width = htonl(*(uint32_t *)(buffer+16));
+        entry.height = htonl(*(uint32_t *)(buffer+20));
+    }
+}
+
+/**
+ * Look up the size of the image in a png file.
+ *
+ * @param  fileName - name of image file.
+ * @param  width - set to the width of the image if found.
+ * @param  height - set to the height of the image if found.
+ * @return true if the file is a valid png file, false otherwise.
+ */
+bool Assets::getImageSize(const std::string & fileName, int & width, int & height)
+{
+    const std::filesystem::path path{fileName};
+
+    std::lock_guard<std::mutex> lock{mutex};
+    Directory & table{scan(path.parent_path().string())};
+    auto it{table.find(path.filename().string())};
+    if (it == table.end())
+        return false;
+
+    Entry & entry{it->second};
+    if (!entry.read)
+        readHeader(fileName, entry);
+
+    if (!entry.valid)
+        return false;
+
+    width = entry.width;
+    height = entry.height;
+
+    return true;
+}
+
+/**
+ * Get the digest of the contents of a file, from the index if the file is
+ * unchanged, otherwise by reading the file.
+ *
+ * @param  fileName - name of file.
+ * @return the digest, or an empty string if the file can't be read.
+ */
+std::string Assets::getContentHash(const std::string & fileName)
+{
+    const std::filesystem::path path{fileName};
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        Directory & table{scan(path.parent_path().string())};
+        auto it{table.find(path.filename().string())};
+        if (it == table.end())
+            return "";
+
+        Entry & entry{it->second};
+        if (!entry.read)
+            readHeader(fileName, entry);
+
+        if (entry.record)
+        {
+            static const char hex[]{"0123456789abcdef"};
+            std::string output{};
+            for (const auto v : entry.record->hash)
+            {
+                output += hex[v >> 4];
+                output += hex[v & 0xF];
+            }
+
+            return output;
+        }
+    }
+
+    return Hash::file(fileName);
+}
+
+/**
+ * Build the persistent index of every file under the given directories.
+ * The index is written to a temporary file and renamed into place.
+ *
+ * @param  roots - directories to index.
+ * @return error value or 0 if no errors.
+ */
+int Assets::buildIndex(const std::vector<std::string> & roots)
+{
+    struct Item
+    {
+        std::string name;
+        FileRecord record;
+    };
+    std::map<std::string, std::pair<int64_t, std::vector<Item>>> tree{};
+
+    auto addDirectory = [&tree](const std::string & path)
+    {
+        struct stat st{};
+        if (stat(path.c_str(), &st) == 0)
+            tree[path].first = getMtime(st);
+    };
+
+//- Walk the directories, reading the header and contents of each file.
+    for (const auto & root : roots)
+    {
+        std::error_code ec{};
+        if (!std::filesystem::is_directory(root, ec))
+            continue;
+
+        addDirectory(root);
+        for (const auto & entry : std::filesystem::recursive_directory_iterator{root, ec})
+        {
+            const std::string path{entry.path().string()};
+            if (entry.is_directory(ec))
+            {
+                addDirectory(path);
+                continue;
+            }
+
+            struct stat st{};
+            if ((!entry.is_regular_file(ec)) || (stat(path.c_str(), &st)))
+                continue;
+
+            Item item{entry.path().filename().string(), FileRecord{}};
+            item.record.size = st.st_size;
+            item.record.mtime = getMtime(st);
+
+            std::ifstream file{path, std::ifstream::in|std::ifstream::binary};
+            char buffer[28]{};
+            file.read(buffer, 24);
+            if ((file) && (isValidPNG(buffer)))
+            {
+                item.record.width = htonl(*(uint32_t *)(buffer+16));
+                item.record.height = htonl(*(uint32_t *)(buffer+20));
+            }
+
+            const std::string digest{Hash::file(path)};
+            for (size_t i{}; (i < sizeof(item.record.hash)) && (digest.length() == 64); ++i)
+                item.record.hash[i] = uint8_t(std::stoi(digest.substr(i * 2, 2), nullptr, 16));
+
+            tree[entry.path().parent_path().string()].second.push_back(item);
+        }
+    }
+
+//- Lay out the records and the string table.
+    Header header{};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    std::vector<DirectoryRecord> directoryRecords{};
+    std::vector<FileRecord> fileRecords{};
+    std::string strings{};
+
+    auto addString = [&strings](const std::string & value, uint32_t & offset, uint32_t & length)
+    {
+        offset = strings.size();
+        length = value.size();
+        strings += value;
+    };
+
+    for (auto & [path, directory] : tree)
+    {
+        auto & [mtime, items] = directory;
+        std::sort(items.begin(), items.end(), [](const Item & a, const Item & b) { return a.name < b.name; });
+
+        DirectoryRecord record{};
+        record.mtime = mtime;
+        record.firstFile = fileRecords.size();
+        record.fileCount = items.size();
+        addString(path, record.pathOffset, record.pathLength);
+        directoryRecords.push_back(record);
+
+        for (auto & item : items)
+        {
+            addString(item.name, item.record.nameOffset, item.record.nameLength);
+            fileRecords.push_back(item.record);
+        }
+    }
+
+    header.directoryCount = directoryRecords.size();
+    header.fileCount = fileRecords.size();
+    header.stringBytes = strings.size();
+
+//- Write the index.
+    const std::string tempFile{_assetIndexFilename + ".tmp"};
+    {
+        std::ofstream file{tempFile, std::ofstream::out|std::ofstream::binary};
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(directoryRecords.data()), directoryRecords.size() * sizeof(DirectoryRecord));
+        file.write(reinterpret_cast<const char *>(fileRecords.data()), fileRecords.size() * sizeof(FileRecord));
+        file.write(strings.data(), strings.size());
+        if (!file)
+        {
+            std::cerr << "Can't write asset index " << tempFile << " - aborting!\n";
+
+            return 1;
+        }
+    }
+
+    std::error_code ec{};
+    std::filesystem::rename(tempFile, _assetIndexFilename, ec);
+    if (ec)
+    {
+        std::cerr << "Can't write asset index " << _assetIndexFilename << " - aborting!\n";
+
+        return 1;
+    }
+
+    std::cout << "Indexed " << fileRecords.size() << " files in " << directoryRecords.size() << " directories as " << _assetIndexFilename << "\n";
+
+    return 0;
+}
+
@@ -0,0 +1,90 @@
+/**
+ * @file    Assets.h
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'cardgen' is a playing card image generator.
+ *
+ * Interface for the Assets class, a table of component images.
+ */
+
+#if !defined _ASSETS_H_INCLUDED_
+#define _ASSETS_H_INCLUDED_
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+/**
+ * @section Assets class.
+ *
+ * Used to answer "does this image exist and what size is it?" from memory.
+ * Each directory is listed once, the first time a file in it is looked up,
+ * so missing files never touch the file system again. The header of each
+ * existing file is read at most once.
+ *
+ * If a persistent index built with --build-index is present, directories
+ * whose modification time is unchanged are taken from the index without
+ * being listed, and files whose size and modification time are unchanged
+ * are taken from the index without being opened.
+ */
+class Assets
+{
+private:
+    struct Header;
+    struct DirectoryRecord;
+    struct FileRecord;
+
+    struct Entry
+    {
+        bool read;
+        bool valid;
+        int width;
+        int height;
+        const FileRecord * record;
+    };
+    using Directory = std::map<std::string, Entry>;
+
+    static std::mutex mutex;
+    static std::map<std::string, Directory> directories;
+
+    static const Header * index;
+    static size_t indexSize;
+
+    static bool isValidPNG(const char * const buffer);
+    static bool isConsistent(const Header * header);
+    static bool loadIndex(void);
+    static const DirectoryRecord * findDirectory(const std::string & directory);
+    static const char * getString(uint32_t offset);
+    static bool isCurrent(const std::string & fileName, const FileRecord * record);
+    static Directory & scan(const std::string & directory);
+    static void readHeader(const std::string & fileName, Entry & entry);
+
+public:
+    static bool getImageSize(const std::string & fileName, int & width, int & height);
+    static std::string getContentHash(const std::string & fileName);
+    static int buildIndex(const std::vector<std::string> & roots);
+
+};
+
+
+#endif //!defined _ASSETS_H_INCLUDED_
+
@@ -0,0 +1,264 @@
+/**
+ * @file    Blend.cpp
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'cardgen' is a playing card image generator.
+ *
+ * Implementation for the Blend class.
+ */
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define BLEND_X86
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define BLEND_NEON
+#endif
+
+#include <iostream>
+#include <random>
+
+#include "Blend.h"
+
+
+/**
+ * @section Blend kernels.
+ *
+ * Each destination channel becomes src + (dst * (255 - srcAlpha)) / 255,
+ * with the division rounded as (v + 128 + ((v + 128) >> 8)) >> 8. Every
+ * intermediate value fits in 16 bits, so the vector versions work on 16-bit
+ * lanes and wrap the final sum to 8 bits exactly as the scalar version does.
+ */
+
+/**
+ * Composite a row of pixels one channel at a time. This is the reference
+ * for the other kernels.
+ *
+ * @param  dst - destination pixels.
+ * @param  src - premultiplied source pixels.
+ * @param  count - number of pixels.
+ */
+void Blend::scalarRow(uint8_t * dst, const uint8_t * src, int count)
+{
+    for (int i{}; i < count; ++i, src += 4, dst += 4)
+    {
+        const uint32_t inverse{255U - src[3]};
+        for (int j{}; j < 4; ++j)
+        {
+            const uint32_t v{(dst[j] * inverse) + 128};
+            dst[j] = uint8_t(src[j] + ((v + (v >> 8)) >> 8));
+        }
+    }
+}
+
+#if defined(BLEND_X86)
+/**
+ * Composite 2 pixels held as 16-bit lanes.
+ *
+ * @param  d - destination pixels.
+ * @param  s - source pixels.
+ * @return the composited pixels.
+ */
+static inline __m128i blend2(__m128i d, __m128i s)
+{
+    const __m128i alpha{_mm_shufflehi_epi16(_mm_shufflelo_epi16(s, 0xFF), 0xFF)};
+    const __m128i inverse{_mm_xor_si128(alpha, _mm_set1_epi16(0xFF))};
+    __m128i v{_mm_add_epi16(_mm_mullo_epi16(d, inverse), _mm_set1_epi16(128))};
+    v = _mm_srli_epi16(_mm_add_epi16(v, _mm_srli_epi16(v, 8)), 8);
+
+    return _mm_and_si128(_mm_add_epi16(s, v), _mm_set1_epi16(0xFF));
+}
+
+/**
+ * Composite a row of pixels 4 at a time using SSE2, which every x86-64
+ * processor has.
+ *
+ * @param  dst - destination pixels.
+ * @param  src - premultiplied source pixels.
+ * @param  count - number of pixels.
+ */
+static void sse2Row(uint8_t * dst, const uint8_t * src, int count)
+{
+    const __m128i zero{_mm_setzero_si128()};
+    int i{};
+    for (; i + 4 <= count; i += 4, src += 16, dst += 16)
+    {
+        const __m128i s{_mm_loadu_si128(reinterpret_cast<const __m128i *>(src))};
+        const __m128i d{_mm_loadu_si128(reinterpret_cast<const __m128i *>(dst))};
+        const __m128i lo{blend2(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(s, zero))};
+        const __m128i hi{blend2(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(s, zero))};
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm_packus_epi16(lo, hi));
+    }
+
+    Blend::scalarRow(dst, src, count - i);
+}
+
+/**
+ * Composite 4 pixels held as 16-bit lanes.
+ *
+ * @param  d - destination pixels.
+ * @param  s - source pixels.
+ * @return the composited pixels.
+ */
+__attribute__((target("avx2")))
+static inline __m256i blend4(__m256i d, __m256i s)
+{
+    const __m256i alpha{_mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s, 0xFF), 0xFF)};
+    const __m256i inverse{_mm256_xor_si256(alpha, _mm256_set1_epi16(0xFF))};
+    __m256i v{_mm256_add_epi16(_mm256_mullo_epi16(d, inverse), _mm256_set1_epi16(128))};
+    v = _mm256_srli_epi16(_mm256_add_epi16(v, _mm256_srli_epi16(v, 8)), 8);
+
+    return _mm256_and_si256(_mm256_add_epi16(s, v), _mm256_set1_epi16(0xFF));
+}
+
+/**
+ * Composite a row of pixels 8 at a time using AVX2. The unpack and pack
+ * instructions work within each 128-bit half, so the pixels stay in order.
+ *
+ * @param  dst - destination pixels.
+ * @param  src - premultiplied source pixels.
+ * @param  count - number of pixels.
+ */
+__attribute__((target("avx2")))
+static void avx2Row(uint8_t * dst, const uint8_t * src, int count)
+{
+    const __m256i zero{_mm256_setzero_si256()};
+    int i{};
+    for (; i + 8 <= count; i += 8, src += 32, dst += 32)
+    {
+        const __m256i s{_mm256_loadu_si256(reinterpret_cast<const __m256i *>(src))};
+        const __m256i d{_mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst))};
+        const __m256i lo{blend4(_mm256_unpacklo_epi8(d, zero), _mm256_unpacklo_epi8(s, zero))};
+        const __m256i hi{blend4(_mm256_unpackhi_epi8(d, zero), _mm256_unpackhi_epi8(s, zero))};
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), _mm256_packus_epi16(lo, hi));
+    }
+
+    sse2Row(dst, src, count - i);
+}
+#endif
+
+#if defined(BLEND_NEON)
+/**
+ * Composite a row of pixels 8 at a time using NEON, with the channels
+ * separated into their own registers.
+ *
+ * @param  dst - destination pixels.
+ * @param  src - premultiplied source pixels.
+ * @param  count - number of pixels.
+ */
+static void neonRow(uint8_t * dst, const uint8_t * src, int count)
+{
+    int i{};
+    for (; i + 8 <= count; i += 8, src += 32, dst += 32)
+    {
+        const uint8x8x4_t s{vld4_u8(src)};
+        uint8x8x4_t d{vld4_u8(dst)};
+        const uint8x8_t inverse{vmvn_u8(s.val[3])};
+        for (int j{}; j < 4; ++j)
+        {
+            uint16x8_t v{vaddq_u16(vmull_u8(d.val[j], inverse), vdupq_n_u16(128))};
+            v = vsraq_n_u16(v, v, 8);
+            d.val[j] = vadd_u8(s.val[j], vshrn_n_u16(v, 8));
+        }
+        vst4_u8(dst, d);
+    }
+
+    Blend::scalarRow(dst, src, count - i);
+}
+#endif
+
+/**
+ * @section Blend class method code.
+ *
+ */
+
+/**
+ * Get the kernels that can be used on this processor, fastest first.
+ *
+ * @return the kernels.
+ */
+std::vector<Blend::Kernel> Blend::getKernels(void)
+{
+    std::vector<Kernel> kernels{};
+#if defined(BLEND_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        kernels.push_back(Kernel{"avx2", avx2Row});
+    kernels.push_back(Kernel{"sse2", sse2Row});
+#elif defined(BLEND_NEON)
+    kernels.push_back(Kernel{"neon", neonRow});
+#endif
+    kernels.push_back(Kernel{"scalar", scalarRow});
+
+    return kernels;
+}
+
+/**
+ * Get the fastest kernel available, choosing it on first use.
+ *
+ * @return the kernel.
+ */
+const Blend::Kernel & Blend::select(void)
+{
+    static const Kernel kernel{getKernels().front()};
+
+    return kernel;
+}
+
+/**
+ * Check every kernel available against the scalar reference, for rows of
+ * many lengths so that the vector tails are covered too. Every other
+ * source pixel isn't a valid premultiplied pixel, so that the channels
+ * that wrap are checked as well.
+ *
+ * @return the number of kernels that differ from the reference.
+ */
+int Blend::check(void)
+{
+    std::mt19937 random{1};
+    std::vector<uint8_t> source(1024 * 4);
+    std::vector<uint8_t> target(1024 * 4);
+    for (size_t i{}; i < source.size(); i += 4)
+    {
+        source[i+3] = uint8_t(random());
+        for (int j{}; j < 3; ++j)
+            source[i+j] = uint8_t(random() % ((i % 8) ? 256U : source[i+3] + 1U));
+    }
+    for (auto & value : target)
+        value = uint8_t(random());
+
+    int mismatches{};
+    for (const auto & kernel : getKernels())
+        for (int count{}; count <= 1024; count += (count < 40) ? 1 : 197)
+        {
+            std::vector<uint8_t> expected{target};
+            std::vector<uint8_t> actual{target};
+            scalarRow(expected.data(), source.data(), count);
+            kernel.row(actual.data(), source.data(), count);
+            if (actual != expected)
+            {
+                std::cerr << "Blend kernel " << kernel.name << " differs from the scalar reference for " << count << " pixels.\n";
+                ++mismatches;
+                break;
+            }
+        }
+
+    return mismatches;
+}
+
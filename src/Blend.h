@@ -0,0 +1,69 @@
+/**
+ * @file    Blend.h
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'cardgen' is a playing card image generator.
+ *
+ * Interface for the Blend class, the kernels used to composite sprites.
+ */
+
+#if !defined _BLEND_H_INCLUDED_
+#define _BLEND_H_INCLUDED_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+/**
+ * @section Blend class.
+ *
+ * Used to composite a row of premultiplied RGBA pixels over another using
+ * source-over blending. This is the inner loop of the native renderer, so
+ * there are vector versions for the instruction sets available, chosen
+ * when first used. Every version gives exactly the same result as the
+ * scalar reference.
+ */
+class Blend
+{
+public:
+    using RowFunction = void (*)(uint8_t * dst, const uint8_t * src, int count);
+
+    struct Kernel
+    {
+        std::string name;
+        RowFunction row;
+    };
+
+private:
+    static const Kernel & select(void);
+
+public:
+    static void scalarRow(uint8_t * dst, const uint8_t * src, int count);
+    static std::vector<Kernel> getKernels(void);
+    static int check(void);
+    static const std::string & getName(void) { return select().name; }
+
+    static void row(uint8_t * dst, const uint8_t * src, int count) { select().row(dst, src, count); }
+
+};
+
+
+#endif //!defined _BLEND_H_INCLUDED_
+
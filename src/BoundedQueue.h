@@ -0,0 +1,104 @@
+/**
+ * @file    BoundedQueue.h
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'cardgen' is a playing card image generator.
+ *
+ * Interface for the BoundedQueue class, used to pass work between threads.
+ */
+
+#if !defined _BOUNDEDQUEUE_H_INCLUDED_
+#define _BOUNDEDQUEUE_H_INCLUDED_
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+
+/**
+ * @section BoundedQueue class.
+ *
+ * Used to connect the stages of a pipeline. A stage that gets ahead of the
+ * next blocks when the queue is full, so the amount of work in flight, and
+ * the memory it holds, is capped by the capacity of the queue.
+ */
+template<typename T>
+class BoundedQueue
+{
+private:
+    const size_t capacity;
+    std::mutex mutex;
+    std::condition_variable notFull;
+    std::condition_variable notEmpty;
+    std::deque<T> items;
+    bool closed;
+
+public:
+    explicit BoundedQueue(size_t c) : capacity{std::max<size_t>(c, 1)}, mutex{}, notFull{}, notEmpty{}, items{}, closed{} {}
+
+    /**
+     * Add an item to the queue, waiting for space if the queue is full.
+     *
+     * @param  item - item to add.
+     */
+    void push(T item)
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        notFull.wait(lock, [this]() { return items.size() < capacity; });
+        items.push_back(std::move(item));
+        notEmpty.notify_one();
+    }
+
+    /**
+     * Take the next item from the queue, waiting for one if the queue is
+     * empty and hasn't been closed.
+     *
+     * @param  item - set to the item taken.
+     * @return true if an item was taken, false if the queue is closed and empty.
+     */
+    bool pop(T & item)
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        notEmpty.wait(lock, [this]() { return (!items.empty()) || (closed); });
+        if (items.empty())
+            return false;
+
+        item = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+
+        return true;
+    }
+
+    /**
+     * Indicate that no more items will be added.
+     */
+    void close(void)
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        closed = true;
+        notEmpty.notify_all();
+    }
+
+};
+
+
+#endif //!defined _BOUNDEDQUEUE_H_INCLUDED_
+
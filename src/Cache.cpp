@@ -0,0 +1,188 @@
+/**
+ * @file    Cache.cpp
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'cardgen' is a playing card image generator.
+ *
+ * Implementation for the Cache class.
+ */
+
+#include <filesystem>
+#include <thread>
+
+#include <unistd.h>
+
+#include "cardgen.h"
+#include "Cache.h"
+#include "Hash.h"
+#include "Assets.h"
+#include "Configuration.h"
+
+
+/**
+ * @section Internal constants and variables.
+ *
+ */
+
+static const std::string version{"cardgen cache 1"};
+
+std::atomic<int> Cache::hits{};
+std::atomic<int> Cache::misses{};
+
+
+/**
+ * @section Cache class method code.
+ *
+ */
+
+/**
+ * Check if the cache has been requested.
+ *
+ * @return true if enabled, false otherwise.
+ */
+bool Cache::isEnabled(void)
+{
+    return Config::isCache();
+}
+
+/**
+ * Generate the path of a cached card from its key, using the first two
+ * digits as a subdirectory to keep directory sizes down.
+ *
+ * @param  key - digest identifying the card.
+ * @return the path of the cached card.
+ */
+std::string Cache::getCacheFilename(const std::string & key)
+{
+    std::filesystem::path path{Config::getCacheDirectory()};
+    path /= key.substr(0, 2);
+    path /= key + ".png";
+
+    return path.string();
+}
+
+/**
+ * Copy a file under a temporary name unique to the thread and rename it
+ * into place, so that the destination is never left holding a partial
+ * image. The copy never shares its storage with the original, as the
+ * 'convert' commands of the script rewrite a card in place, which would
+ * otherwise change the cached card too. Any existing destination file is
+ * replaced.
+ *
+ * @param  from - existing file.
+ * @param  to - new file.
+ * @return true if successful, false otherwise.
+ */
+bool Cache::copy(const std::string & from, const std::string & to)
+{
+    const std::string tempFile{to + "." + std::to_string(getpid()) + "." +
+        std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp"};
+
+    std::error_code ec{};
+    std::filesystem::copy_file(from, tempFile, std::filesystem::copy_options::overwrite_existing, ec);
+    if (!ec)
+        std::filesystem::rename(tempFile, to, ec);
+
+    if (ec)
+    {
+        std::filesystem::remove(tempFile, ec);
+
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Generate the key for a card. This is a digest of the fully resolved
+ * 'convert' arguments (which include the card size, colour and outline),
+ * the contents of every component image, any shared layer and the
+ * renderer used.
+ *
+ * @param  context - context of the deck.
+ * @param  card - card to generate the key for.
+ * @param  renderer - name identifying the renderer and its settings.
+ * @return the key.
+ */
+std::string Cache::getKey(const RenderContext & context, const Card & card, const std::string & renderer)
+{
+    Hash hash{};
+    hash.update(version + '\n' + renderer + '\n');
+
+    // The output file name doesn't affect the image, so leave it out, as
+    // well as the file name of any shared layer, whose key is added below.
+    auto args{genCardArgs(context, card)};
+    args.pop_back();
+    if (card.getBase())
+        args.erase(args.begin() + 1);
+    for (const auto & arg : args)
+        hash.update(arg + '\0');
+
+    for (const auto & op : card)
+        if (op.isImage())
+            hash.update(Assets::getContentHash(op.getFileName()) + '\0');
+
+    // A card drawn on a shared layer depends on everything the layer does.
+    if (card.getBase())
+        hash.update(getKey(context, *card.getBase(), renderer) + '\0');
+
+    return hash.digest();
+}
+
+/**
+ * Retrieve a card from the cache if it is present.
+ *
+ * @param  key - key of the card.
+ * @param  fileName - output file name for the card.
+ * @return true if the card was retrieved, false otherwise.
+ */
+bool Cache::fetch(const std::string & key, const std::string & fileName)
+{
+    const std::string cacheFile{getCacheFilename(key)};
+    if ((!std::filesystem::exists(cacheFile)) || (!copy(cacheFile, fileName)))
+    {
+        ++misses;
+
+        return false;
+    }
+
+    ++hits;
+
+    return true;
+}
+
+/**
+ * Add a rendered card to the cache.
+ *
+ * @param  key - key of the card.
+ * @param  fileName - rendered card.
+ * @return true if the card was stored, false otherwise.
+ */
+bool Cache::store(const std::string & key, const std::string & fileName)
+{
+    const std::string cacheFile{getCacheFilename(key)};
+
+    std::error_code ec{};
+    std::filesystem::create_directories(std::filesystem::path{cacheFile}.parent_path(), ec);
+    if (ec)
+        return false;
+
+    return copy(fileName, cacheFile);
+}
+
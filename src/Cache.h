@@ -0,0 +1,66 @@
+/**
+ * @file    Cache.h
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'cardgen' is a playing card image generator.
+ *
+ * Interface for the Cache class, a content-addressed store of rendered cards.
+ */
+
+#if !defined _CACHE_H_INCLUDED_
+#define _CACHE_H_INCLUDED_
+
+#include <atomic>
+#include <string>
+
+#include "Card.h"
+
+class RenderContext;
+
+
+/**
+ * @section Cache class.
+ *
+ * Used to store rendered cards keyed on a digest of everything that affects
+ * the rendered image, so identical cards are copied rather than
+ * rendered again.
+ */
+class Cache
+{
+private:
+    static std::atomic<int> hits;
+    static std::atomic<int> misses;
+
+    static std::string getCacheFilename(const std::string & key);
+    static bool copy(const std::string & from, const std::string & to);
+
+public:
+    static bool isEnabled(void);
+    static std::string getKey(const RenderContext & context, const Card & card, const std::string & renderer);
+    static bool fetch(const std::string & key, const std::string & fileName);
+    static bool store(const std::string & key, const std::string & fileName);
+
+    static int getHits(void) { return hits; }
+    static int getMisses(void) { return misses; }
+
+};
+
+
+#endif //!defined _CACHE_H_INCLUDED_
+
@@ -0,0 +1,414 @@
+/**
+ * @file    Canvas.cpp
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'cardgen' is a playing card image generator.
+ *
+ * Implementation for the Canvas class.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+
+#include <png.h>
+
+#include "Canvas.h"
+#include "Blend.h"
+#include "PngReader.h"
+#include "PngWriter.h"
+
+
+/**
+ * @section Internal constants and variables.
+ *
+ */
+
+static const std::map<std::string, Canvas::Pixel> colourNames{
+    { "transparent",    {   0,   0,   0,   0 } },
+    { "none",           {   0,   0,   0,   0 } },
+    { "white",          { 255, 255, 255, 255 } },
+    { "black",          {   0,   0,   0, 255 } },
+    { "red",            { 255,   0,   0, 255 } },
+    { "green",          {   0, 128,   0, 255 } },
+    { "lime",           {   0, 255,   0, 255 } },
+    { "blue",           {   0,   0, 255, 255 } },
+    { "yellow",         { 255, 255,   0, 255 } },
+    { "cyan",           {   0, 255, 255, 255 } },
+    { "magenta",        { 255,   0, 255, 255 } },
+    { "grey",           { 190, 190, 190, 255 } },
+    { "gray",           { 190, 190, 190, 255 } },
+    { "lightgrey",      { 211, 211, 211, 255 } },
+    { "lightgray",      { 211, 211, 211, 255 } },
+    { "silver",         { 192, 192, 192, 255 } },
+    { "ivory",          { 255, 255, 240, 255 } },
+    { "beige",          { 245, 245, 220, 255 } },
+    { "linen",          { 250, 240, 230, 255 } },
+    { "snow",           { 255, 250, 250, 255 } },
+    { "seashell",       { 255, 245, 238, 255 } },
+    { "cornsilk",       { 255, 248, 220, 255 } },
+    { "floralwhite",    { 255, 250, 240, 255 } },
+    { "ghostwhite",     { 248, 248, 255, 255 } },
+    { "oldlace",        { 253, 245, 230, 255 } },
+    { "antiquewhite",   { 250, 235, 215, 255 } },
+    { "wheat",          { 245, 222, 179, 255 } },
+    { "khaki",          { 240, 230, 140, 255 } },
+    { "lavender",       { 230, 230, 250, 255 } },
+    { "pink",           { 255, 192, 203, 255 } },
+    { "orange",         { 255, 165,   0, 255 } },
+    { "gold",           { 255, 215,   0, 255 } },
+    { "navy",           {   0,   0, 128, 255 } },
+    { "maroon",         { 128,   0,   0, 255 } },
+    { "purple",         { 128,   0, 128, 255 } },
+
+};
+
+
+/**
+ * @section Internal support code.
+ *
+ */
+
+/**
+ * Divide by 255 with correct rounding for values up to 255*255.
+ *
+ * @param  v - value to divide.
+ * @return the rounded quotient.
+ */
+static inline uint32_t div255(uint32_t v)
+{
+    v += 128;
+    return (v + (v >> 8)) >> 8;
+}
+
+/**
+ * Scale a premultiplied pixel by a coverage value in the range 0 to 1.
+ *
+ * @param  colour - premultiplied pixel to scale.
+ * @param  coverage - amount of the pixel covered.
+ * @return the scaled pixel.
+ */
+static Canvas::Pixel scale(const Canvas::Pixel & colour, float coverage)
+{
+    Canvas::Pixel ret{};
+    for (int i{}; i < 4; ++i)
+        ret[i] = uint8_t(colour[i] * coverage + 0.5F);
+
+    return ret;
+}
+
+/**
+ * Composite a single premultiplied pixel over a destination pixel.
+ *
+ * @param  dst - destination pixel.
+ * @param  src - premultiplied source pixel.
+ */
+static inline void blend(uint8_t * dst, const uint8_t * src)
+{
+    const uint32_t inverse{255U - src[3]};
+    for (int i{}; i < 4; ++i)
+        dst[i] = uint8_t(src[i] + div255(dst[i] * inverse));
+}
+
+/**
+ * Parse a hex colour string of the form "#RGB", "#RRGGBB" or "#RRGGBBAA".
+ *
+ * @param  name - colour string.
+ * @param  colour - parsed colour.
+ * @return true if valid, false otherwise.
+ */
+static bool parseHex(const std::string & name, Canvas::Pixel & colour)
+{
+    const size_t len{name.length() - 1};
+    if ((len != 3) && (len != 6) && (len != 8))
+        return false;
+
+    if (name.find_first_not_of("0123456789abcdefABCDEF", 1) != std::string::npos)
+        return false;
+
+    colour = { 0, 0, 0, 255 };
+    if (len == 3)
+    {
+        for (int i{}; i < 3; ++i)
+            colour[i] = uint8_t(std::stoi(name.substr(1 + i, 1), nullptr, 16) * 17);
+    }
+    else
+    {
+        for (int i{}; i < int(len / 2); ++i)
+            colour[i] = uint8_t(std::stoi(name.substr(1 + (2 * i), 2), nullptr, 16));
+    }
+
+    return true;
+}
+
+
+/**
+ * @section Canvas class method code.
+ *
+ */
+
+/**
+ * Parse a colour name as used by ImageMagick into a premultiplied pixel.
+ * Only the common names and hex formats are supported.
+ *
+ * @param  name - colour name.
+ * @param  colour - parsed colour.
+ * @return true if valid, false otherwise.
+ */
+bool Canvas::parseColour(const std::string & name, Pixel & colour)
+{
+    std::string lower{name};
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+
+    bool valid{};
+    if ((!lower.empty()) && (lower[0] == '#'))
+        valid = parseHex(lower, colour);
+    else
+    {
+        auto it{colourNames.find(lower)};
+        if (it != colourNames.end())
+        {
+            colour = it->second;
+            valid = true;
+        }
+    }
+
+    if (valid)
+        for (int i{}; i < 3; ++i)
+            colour[i] = uint8_t(div255(colour[i] * colour[3]));
+
+    return valid;
+}
+
+/**
+ * Load a .png file, converting it to premultiplied RGBA. The file is decoded
+ * by PngReader, falling back to libpng for the files it leaves alone.
+ *
+ * @param  fileName - name of image file.
+ * @return true if loaded, false otherwise.
+ */
+bool Canvas::load(const std::string & fileName)
+{
+    if (PngReader::read(fileName, width, height, pixels))
+        return true;
+
+    png_image image{};
+    image.version = PNG_IMAGE_VERSION;
+
+    if (!png_image_begin_read_from_file(&image, fileName.c_str()))
+        return false;
+
+    image.format = PNG_FORMAT_RGBA;
+    std::vector<uint8_t> buffer(PNG_IMAGE_SIZE(image));
+    if (!png_image_finish_read(&image, nullptr, buffer.data(), 0, nullptr))
+    {
+        png_image_free(&image);
+
+        return false;
+    }
+
+    width = image.width;
+    height = image.height;
+    pixels = std::move(buffer);
+
+    for (size_t i{}; i < pixels.size(); i += 4)
+    {
+        const uint32_t alpha{pixels[i+3]};
+        for (int j{}; j < 3; ++j)
+            pixels[i+j] = uint8_t(div255(pixels[i+j] * alpha));
+    }
+
+    return true;
+}
+
+/**
+ * Save the canvas as a .png file, converting it back to straight RGBA.
+ *
+ * @param  fileName - name of image file.
+ * @return true if saved, false otherwise.
+ */
+bool Canvas::save(const std::string & fileName) const
+{
+    size_t bytes{};
+
+    return PngWriter::write(fileName, *this, PngWriter::Level::DEFAULT, bytes);
+}
+
+/**
+ * Set the size of the canvas and clear it, reusing the existing storage
+ * where possible.
+ *
+ * @param  w - width of the canvas.
+ * @param  h - height of the canvas.
+ */
+void Canvas::reset(int w, int h)
+{
+    width = w;
+    height = h;
+    pixels.assign(size_t(std::max(w, 0)) * std::max(h, 0) * 4, 0);
+}
+
+/**
+ * Resize the canvas into another using a separable filter, first along each
+ * row then down each column. The output and intermediate buffers are reused,
+ * so that resizing many sprites doesn't allocate memory for each one.
+ *
+ * @param  w - width of the resized image.
+ * @param  h - height of the resized image.
+ * @param  output - set to the resized image.
+ * @param  temp - buffer for the intermediate image.
+ * @param  filter - filter to use.
+ */
+void Canvas::resize(int w, int h, Canvas & output, std::vector<float> & temp, Resample::Filter filter) const
+{
+    if ((w == width) && (h == height))
+    {
+        output = *this;
+
+        return;
+    }
+
+    output.reset(w, h);
+    if ((w <= 0) || (h <= 0) || (isEmpty()))
+        return;
+
+    const auto & columns{Resample::getWeights(filter, width, w)};
+    const auto & rows{Resample::getWeights(filter, height, h)};
+    const size_t length{size_t(w) * 4};
+
+    // Horizontal pass, followed by a spare row for the vertical pass.
+    temp.resize((size_t(height) + 1) * length);
+    for (int y{}; y < height; ++y)
+        Resample::horizontal(temp.data() + (y * length), getRow(y), columns);
+
+    // Vertical pass.
+    float * sum{temp.data() + (height * length)};
+    for (int y{}; y < h; ++y)
+    {
+        Resample::vertical(sum, temp.data() + (rows.first[y] * length), length,
+            rows.values.data() + (size_t(y) * rows.taps), rows.count[y], int(length));
+
+        uint8_t * dst{output.getRow(y)};
+        for (size_t x{}; x < length; x += 4, dst += 4)
+        {
+            for (int j{}; j < 4; ++j)
+                dst[j] = uint8_t(std::clamp(sum[x+j] + 0.5F, 0.0F, 255.0F));
+
+            // Keep the colour channels valid for premultiplied alpha.
+            for (int j{}; j < 3; ++j)
+                dst[j] = std::min(dst[j], dst[3]);
+        }
+    }
+}
+
+/**
+ * Composite a sprite over the canvas at the given position, clipping to the
+ * canvas as required. Each row is blended by the fastest Blend kernel.
+ *
+ * @param  sprite - premultiplied image to composite.
+ * @param  x - X position of the top left corner of the sprite.
+ * @param  y - Y position of the top left corner of the sprite.
+ */
+void Canvas::over(const Canvas & sprite, int x, int y)
+{
+    const int left{std::max(0, -x)};
+    const int top{std::max(0, -y)};
+    const int right{std::min(sprite.getWidth(), width - x)};
+    const int bottom{std::min(sprite.getHeight(), height - y)};
+
+    if (right <= left)
+        return;
+
+    for (int row{top}; row < bottom; ++row)
+        Blend::row(getRow(row + y) + ((left + x) * 4), sprite.getRow(row) + (left * 4), right - left);
+}
+
+/**
+ * Rotate the canvas by 180 degrees.
+ */
+void Canvas::rotate180(void)
+{
+    const size_t count{size_t(width) * height};
+    for (size_t i{}, j{count - 1}; (count) && (i < j); ++i, --j)
+    {
+        uint8_t temp[4];
+        std::memcpy(temp, &pixels[i * 4], 4);
+        std::memcpy(&pixels[i * 4], &pixels[j * 4], 4);
+        std::memcpy(&pixels[j * 4], temp, 4);
+    }
+}
+
+/**
+ * Draw an anti-aliased, optionally rounded, rectangle. Coordinates are pixel
+ * centres, as used by ImageMagick's 'rectangle' and 'roundRectangle'. With
+ * no stroke the rectangle covers the full area of the corner pixels.
+ *
+ * @param  x0 - left edge.
+ * @param  y0 - top edge.
+ * @param  x1 - right edge.
+ * @param  y1 - bottom edge.
+ * @param  radius - corner radius, or 0 for square corners.
+ * @param  fill - premultiplied fill colour.
+ * @param  stroke - premultiplied stroke colour.
+ * @param  strokeWidth - stroke width, or 0 for no stroke.
+ */
+void Canvas::rectangle(float x0, float y0, float x1, float y1, float radius,
+    const Pixel & fill, const Pixel & stroke, float strokeWidth)
+{
+    if (strokeWidth <= 0)
+    {
+        x0 -= 0.5F;
+        y0 -= 0.5F;
+        x1 += 0.5F;
+        y1 += 0.5F;
+    }
+
+    const float cx{(x0 + x1) / 2};
+    const float cy{(y0 + y1) / 2};
+    const float bx{((x1 - x0) / 2) - radius};
+    const float by{((y1 - y0) / 2) - radius};
+    const float halfStroke{strokeWidth / 2};
+
+    for (int y{}; y < height; ++y)
+    {
+        uint8_t * dst{getRow(y)};
+        for (int x{}; x < width; ++x, dst += 4)
+        {
+            // Signed distance from the pixel centre to the rectangle outline.
+            const float qx{std::fabs(x - cx) - bx};
+            const float qy{std::fabs(y - cy) - by};
+            const float ox{std::max(qx, 0.0F)};
+            const float oy{std::max(qy, 0.0F)};
+            const float distance{std::sqrt((ox * ox) + (oy * oy)) + std::min(std::max(qx, qy), 0.0F) - radius};
+
+            const float fillCoverage{std::clamp(0.5F - distance, 0.0F, 1.0F)};
+            if (fillCoverage > 0)
+                blend(dst, scale(fill, fillCoverage).data());
+
+            if (strokeWidth > 0)
+            {
+                const float strokeCoverage{std::clamp(halfStroke + 0.5F - std::fabs(distance), 0.0F, 1.0F)};
+                if (strokeCoverage > 0)
+                    blend(dst, scale(stroke, strokeCoverage).data());
+            }
+        }
+    }
+}
+
@@ -0,0 +1,80 @@
+/**
+ * @file    Canvas.h
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'cardgen' is a playing card image generator.
+ *
+ * Interface for the Canvas class.
+ */
+
+#if !defined _CANVAS_H_INCLUDED_
+#define _CANVAS_H_INCLUDED_
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Resample.h"
+
+
+/**
+ * @section Canvas class.
+ *
+ * Used to hold an image as premultiplied 8-bit RGBA pixels and to provide
+ * the drawing operations needed to compose a card.
+ */
+class Canvas
+{
+public:
+    using Pixel = std::array<uint8_t, 4>;
+
+private:
+    int width;
+    int height;
+    std::vector<uint8_t> pixels;
+
+public:
+    Canvas(void) : width{}, height{}, pixels{} {}
+    Canvas(int w, int h) : width{w}, height{h}, pixels(size_t(w) * h * 4, 0) {}
+
+    int getWidth(void) const { return width; }
+    int getHeight(void) const { return height; }
+    bool isEmpty(void) const { return pixels.empty(); }
+
+    uint8_t * getRow(int y) { return pixels.data() + (size_t(y) * width * 4); }
+    const uint8_t * getRow(int y) const { return pixels.data() + (size_t(y) * width * 4); }
+
+    bool load(const std::string & fileName);
+    bool save(const std::string & fileName) const;
+
+    void reset(int w, int h);
+    void resize(int w, int h, Canvas & output, std::vector<float> & temp, Resample::Filter filter = Resample::Filter::BILINEAR) const;
+    void over(const Canvas & sprite, int x, int y);
+    void rotate180(void);
+    void rectangle(float x0, float y0, float x1, float y1, float radius,
+        const Pixel & fill, const Pixel & stroke, float strokeWidth);
+
+    static bool parseColour(const std::string & name, Pixel & colour);
+
+};
+
+
+#endif //!defined _CANVAS_H_INCLUDED_
+
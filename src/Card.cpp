@@ -0,0 +1,144 @@
+/**
+ * @file    Card.cpp
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'cardgen' is a playing card image generator.
+ *
+ * Implementation for the Op and Card classes.
+ */
+
+#include "Card.h"
+
+
+/**
+ * Generate the 'convert' geometry offset for the operation, with explicit
+ * signs as required for negative offsets.
+ *
+ * @return the offset.
+ */
+std::string Op::getOffset(void) const
+{
+    return (x < 0 ? "" : "+") + std::to_string(x) + (y < 0 ? "" : "+") + std::to_string(y);
+}
+
+/**
+ * print function for Op class. Generates the 'convert' script line for the
+ * operation.
+ *
+ * @param  os - output stream.
+ */
+void Op::print(std::ostream &os) const
+{
+    switch (type)
+    {
+    case Type::IMAGE:
+        if (rotated)
+            os << "\t\\( '" << fileName << "' -resize " << w << 'x' << h << "! -rotate 180 \\) -geometry " << getOffset() << " -composite \\\n";
+        else
+            os << "\t-draw \"image over " << x << ',' << y << ' ' << w << ',' << h << " '" << fileName << "'\" \\\n";
+        break;
+
+    case Type::ROTATE:
+        os << "\t-rotate 180 \\\n";
+        break;
+
+    default:
+        break;
+    }
+}
+
+/**
+ * Append the 'convert' arguments for the operation to an argument vector.
+ * This is the unquoted equivalent of the script line.
+ *
+ * @param  args - argument vector.
+ */
+void Op::addArgs(std::vector<std::string> & args) const
+{
+    switch (type)
+    {
+    case Type::IMAGE:
+        if (rotated)
+            args.insert(args.end(), { "(", fileName, "-resize", std::to_string(w) + 'x' + std::to_string(h) + '!',
+                "-rotate", "180", ")", "-geometry", getOffset(), "-composite" });
+        else
+        {
+            args.push_back("-draw");
+            args.push_back("image over " + std::to_string(x) + ',' + std::to_string(y) + ' ' + std::to_string(w) + ',' + std::to_string(h) + " '" + fileName + "'");
+        }
+        break;
+
+    case Type::ROTATE:
+        args.push_back("-rotate");
+        args.push_back("180");
+        break;
+
+    default:
+        break;
+    }
+}
+
+/**
+ * Remove the rotations from the card by drawing every image that is
+ * followed by an odd number of rotations at its point mirrored position,
+ * rotated by 180 degrees. This gives the same card, without any full card
+ * rotations, as long as the card template is itself symmetric.
+ *
+ * @param  width - width of the card.
+ * @param  height - height of the card.
+ */
+void Card::mirror(int width, int height)
+{
+    int rotations{};
+    for (const auto & op : ops)
+        if (op.isRotate())
+            ++rotations;
+
+    Container output{};
+    for (const auto & op : ops)
+    {
+        if (op.isRotate())
+            --rotations;
+        else
+        if (rotations % 2)
+            output.push_back(op.mirror(width, height));
+        else
+            output.push_back(op);
+    }
+
+    ops = output;
+}
+
+/**
+ * Estimate the cost of drawing the card from the area of its component
+ * images, so that the court cards with their large face images and the
+ * cards with the most pips are started first.
+ *
+ * @return the estimated cost.
+ */
+long Card::estimateCost(void) const
+{
+    long cost{};
+    for (const auto & op : ops)
+        if (op.isImage())
+            cost += long(op.getW()) * op.getH();
+
+    return cost;
+}
+
@@ -0,0 +1,129 @@
+/**
+ * @file    Card.h
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'cardgen' is a playing card image generator.
+ *
+ * Interface for the Op and Card classes.
+ */
+
+#if !defined _CARD_H_INCLUDED_
+#define _CARD_H_INCLUDED_
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+/**
+ * @section Op class.
+ *
+ * Used to capture a single resolved drawing operation applied to a card. An
+ * image may be drawn rotated by 180 degrees in place of rotating the card.
+ */
+class Op
+{
+public:
+    enum class Type { NONE, IMAGE, ROTATE };
+
+private:
+    Type type;
+    int x;
+    int y;
+    int w;
+    int h;
+    std::string fileName;
+    bool rotated;
+
+public:
+    Op(void) : type{Type::NONE}, x{}, y{}, w{}, h{}, fileName{}, rotated{} {}
+    Op(int X, int Y, int W, int H, const std::string & FN, bool R=false) : type{Type::IMAGE}, x{X}, y{Y}, w{W}, h{H}, fileName{FN}, rotated{R} {}
+    static Op rotate(void) { Op op{}; op.type = Type::ROTATE; return op; }
+    Op mirror(int width, int height) const { return Op{width - x - w, height - y - h, w, h, fileName, !rotated}; }
+
+    Type getType(void) const { return type; }
+    bool isNone(void) const { return type == Type::NONE; }
+    bool isImage(void) const { return type == Type::IMAGE; }
+    bool isRotate(void) const { return type == Type::ROTATE; }
+
+    int getX(void) const { return x; }
+    int getY(void) const { return y; }
+    int getW(void) const { return w; }
+    int getH(void) const { return h; }
+    const std::string & getFileName(void) const { return fileName; }
+    bool isRotated(void) const { return rotated; }
+
+    void addArgs(std::vector<std::string> & args) const;
+
+    friend std::ostream & operator<<(std::ostream &os, const Op &A) { A.print(os); return os; }
+
+protected:
+    std::string getOffset(void) const;
+    void print(std::ostream &os=std::cout) const;
+
+};
+
+
+/**
+ * @section Card class.
+ *
+ * Used to capture the sequence of operations that draw a single card on
+ * top of the blank card template, or on top of a shared base layer if one
+ * has been set. A layer is itself a Card that is drawn once and reused by
+ * several cards; it is kept at full colour depth as it is not a final card.
+ */
+class Card
+{
+public:
+    using Container = std::vector<Op>;
+    using Iterator = Container::const_iterator;
+
+private:
+    std::string name;
+    std::string comment;
+    Container ops;
+    bool layer;
+    std::shared_ptr<const Card> base;
+
+public:
+    Card(const std::string & N, const std::string & C, bool L=false) : name{N}, comment{C}, ops{}, layer{L}, base{} {}
+
+    void add(const Op & op) { if (!op.isNone()) ops.push_back(op); }
+    void add(const Container & v) { for (const auto & op : v) add(op); }
+    void rotate(void) { ops.push_back(Op::rotate()); }
+    void setBase(const std::shared_ptr<const Card> & b) { base = b; }
+    void mirror(int width, int height);
+    long estimateCost(void) const;
+
+    const std::string & getName(void) const { return name; }
+    const std::string & getComment(void) const { return comment; }
+    bool isLayer(void) const { return layer; }
+    const Card * getBase(void) const { return base.get(); }
+
+    Iterator begin(void) const { return ops.begin(); }
+    Iterator end(void) const { return ops.end(); }
+
+};
+
+using Deck = std::vector<Card>;
+
+
+#endif //!defined _CARD_H_INCLUDED_
+
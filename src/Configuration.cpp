@@ -27,12 +27,14 @@
 #include <algorithm>
 #include <fstream>
 #include <filesystem>
+#include <sstream>
+#include <set>
 
 #include "cardgen.h"
 
 #include "Opts.h"
 #include "Configuration.h"
-#include "Loc.h"
+#include "RenderContext.h"
 
 
 /**
@@ -73,6 +75,28 @@ const Opts::OptsType optList
     { 'm', "MPC",               NULL,       "Generate MakePlayingCards image (default: " + std::string(_mpc ? "true" : "false") + ", see: https://www.makeplayingcards.com/)." },
     { 'q', "Quad",              NULL,       "Generate pips and indices in all 4 corners (default: " + std::string(_quad ? "true" : "false") + ")." },
     { 0,  NULL, NULL, "" },
+    { 16,  "render",            NULL,       "Render the cards directly to .png files instead of generating the script." },
+    { 17,  "makefile",          "filename", "Generate a Makefile for 'make -j' instead of the script (e.g. \"" + _makeFilename + "\")." },
+    { 18,  "jobs",              "integer",  "Run the 'convert' commands directly using this many parallel jobs instead of generating the script, or the number of threads used by --render." },
+    { 19,  "retries",           "integer",  "Number of times a failed 'convert' command is retried (default: " + std::to_string(_retries) + ")." },
+    { 20,  "cache",             "directory","Reuse identical cards from this cache directory with --render or --jobs." },
+    { 21,  "build-index",       NULL,       "Index the sizes and contents of all component images in \"" + _assetIndexFilename + "\" and nothing else." },
+    { 22,  "layers",            NULL,       "Draw the blank card and corner pips once per suit and draw each card on top." },
+    { 23,  "mpr",               NULL,       "Generate a script that draws every card using a single 'convert' process." },
+    { 24,  "mirror",            NULL,       "Draw the lower half of each card directly instead of rotating the card." },
+    { 25,  "batch",             "filename", "Generate every deck described in this file, one deck of settings per line (e.g. \"face=2 output=deck2 MPC\")." },
+    { 26,  "sweep",             NULL,       "Render a contact sheet of each card for every combination of the ranges given as start:end:step for the % settings." },
+    { 27,  "filter",            "name",     "Filter used by --render to resize images, \"bilinear\" or \"lanczos3\" (default: \"" + Resample::getFilterName(_filter) + "\")." },
+    { 28,  "sprite-cache",      "megabytes","Memory used by --render to keep component images scaled to the size they are drawn at, 0 to scale them every time (default: " + std::to_string(_spriteCache) + ")." },
+    { 29,  "colours",           "integer",  "Reduce each card drawn by --render to this many colours, from 2 to 256, or 0 for full colour (default: " + std::to_string(_colours) + ")." },
+    { 30,  "dither",            "name",     "Dither used when reducing the colours, \"none\", \"ordered\" or \"diffusion\" (default: \"" + Quantize::getDitherName(_dither) + "\")." },
+    { 31,  "shared-palette",    NULL,       "Reduce every card of a deck to the same palette, chosen from the colours of all the cards." },
+    { 32,  "png-level",         "name",     "Speed of the .png encoder used by --render, \"fast\", \"default\" or \"max\" for the smallest files (default: \"" + PngWriter::getLevelName(_pngLevel) + "\")." },
+    { 33,  "incremental",       NULL,       "Only draw the cards whose inputs have changed since they were last drawn, as recorded in \"" + _recordFilename + "\" in the output directory." },
+    { 34,  "resume",            NULL,       "Continue an interrupted run, skipping the cards it finished once their .png files have been checked." },
+    { 35,  "shard",             "i/n",      "Only draw the i-th of n shares of the cards, balanced by cost, so that n processes can split the work (e.g. 3/8)." },
+    { 36,  "cards",             "list",     "Only lay out these cards, as suits with their cards or * for all, and jokers (e.g. \"S:A,K;H:*;jokers\")." },
+    { 0,  NULL, NULL, "" },
     { 1,   "IndexHeight",       "value",    "Height of index as a % of card height (default: " + _indexInfo.getHStr() + ")." },
     { 2,   "IndexCentreX",      "value",    "X value of centre of index as a % of card width (default: " + _indexInfo.getXStr() + ")." },
     { 3,   "IndexCentreY",      "value",    "Y value of centre of index as a % of card height (default: " + _indexInfo.getYStr() + ")." },
@@ -106,6 +130,7 @@ int Config::help(const std::string & error) const
     std::cout << "Usage: " << name << " [Options]\n";
     std::cout << "\n";
     std::cout << "  Generates the bash script \"" << scriptFilename << "\" which uses 'convert' to draw a deck of playing cards.\n";
+    std::cout << "  Alternatively, renders the deck of playing cards directly using --render.\n";
     std::cout << "\n";
     std::cout << "  Options:\n";
     std::cout << optSet;
@@ -125,6 +150,145 @@ int Config::help(const std::string & error) const
 }
 
 
+/**
+ * Check if an option is one of the % settings that can be given a range of
+ * values with --sweep.
+ *
+ * @param  id - option identifier.
+ * @return true if the option can be swept, false otherwise.
+ */
+static bool isSweepOption(int id)
+{
+    return (id >= 1) && (id <= 15) && (id != 12);
+}
+
+
+/**
+ * Parse the shard given to --shard as "i/n".
+ *
+ * @param  value - shard to parse.
+ * @param  index - set to the number of the shard, from 1.
+ * @param  count - set to the number of shards.
+ * @return true if the shard is valid, false otherwise.
+ */
+static bool parseShard(const std::string & value, int & index, int & count)
+{
+    std::istringstream stream{value};
+    char slash{};
+    if ((!(stream >> index >> slash >> count)) || (slash != '/') || (!stream.eof()))
+        return false;
+
+    return (count >= 1) && (index >= 1) && (index <= count);
+}
+
+
+/**
+ * Apply a single option to the configuration.
+ *
+ * @param  option - option to apply.
+ * @return value if precessing should be aborted or 0 otherwise.
+ */
+int Config::setOption(const Arg & option)
+{
+    switch (option.getOpt())
+    {
+    case 'H': return help("");
+    case 'v': return version();
+
+    case 'w': cardWidthPx = option.getArgInt();             break;
+    case 'h': cardHeightPx = option.getArgInt();            break;
+    case 'c': cardColour = option.getArg();                 break;
+
+    case 'i': setIndexDirectory(option.getArg());           break;
+    case 'p': setPipDirectory(option.getArg());             break;
+    case 'f': setFaceDirectory(option.getArg());            break;
+
+    case 's': scriptFilename = option.getArg();             break;
+    case 'o': setOutputDirectory(option.getArg());          break;
+
+    case 'a': keepAspectRatio = true;                       break;
+    case 'm': mpc = true;                                   break;
+    case 'q': quad = true;                                  break;
+    case 16:  render = true;                                break;
+    case 17:  makeFilename = option.getArg();               break;
+    case 18:  jobs = option.getArgInt();                    break;
+    case 19:  retries = option.getArgInt();                 break;
+    case 20:  cacheDirectory = option.getArg();             break;
+    case 21:  buildIndex = true;                            break;
+    case 22:  layers = true;                                break;
+    case 23:  mpr = true;                                   break;
+    case 24:  mirror = true;                                break;
+    case 25:  batchFilename = option.getArg();              break;
+    case 26:  sweep = true;                                 break;
+    case 27:
+        if (!Resample::parseFilter(option.getArg(), filter))
+            return help("unknown filter \"" + option.getArg() + "\".");
+        break;
+    case 28:  spriteCache = option.getArgInt();             break;
+    case 29:
+        colours = option.getArgInt();
+        if ((colours == 1) || (colours < 0) || (colours > 256))
+            return help("colours must be from 2 to 256, or 0.");
+        break;
+    case 30:
+        if (!Quantize::parseDither(option.getArg(), dither))
+            return help("unknown dither \"" + option.getArg() + "\".");
+        break;
+    case 31:  sharedPalette = true;                         break;
+    case 32:
+        if (!PngWriter::parseLevel(option.getArg(), pngLevel))
+            return help("unknown png level \"" + option.getArg() + "\".");
+        break;
+    case 33:  incremental = true;                           break;
+    case 34:  resume = true;                                break;
+    case 35:
+        if (!parseShard(option.getArg(), shard, shards))
+            return help("shard must be given as i/n with i from 1 to n.");
+        break;
+    case 36:
+        if (!parseCards(option.getArg(), cards))
+            return help("unknown cards \"" + option.getArg() + "\".");
+        break;
+
+    case 1:   indexInfo.setH(option.getArgFloat());         break;
+    case 2:   indexInfo.setX(option.getArgFloat());         break;
+    case 3:   indexInfo.setY(option.getArgFloat());         break;
+
+    case 4:   cornerPipInfo.setH(option.getArgFloat());     break;
+    case 5:   cornerPipInfo.setX(option.getArgFloat());     break;
+    case 6:   cornerPipInfo.setY(option.getArgFloat());     break;
+
+    case 7:   standardPipInfo.setH(option.getArgFloat());   break;
+    case 8:   standardPipInfo.setX(option.getArgFloat());   break;
+    case 9:   standardPipInfo.setY(option.getArgFloat());   break;
+
+    case 10:  imageBorderX = option.getArgFloat();          break;
+    case 11:  imageBorderY = option.getArgFloat();          break;
+    case 12:  imagePipInfo.setH(0);                         break;
+    case 13:  imagePipInfo.setH(option.getArgFloat());      break;
+    case 14:  imagePipInfo.setX(option.getArgFloat());      break;
+    case 15:  imagePipInfo.setY(option.getArgFloat());      break;
+
+    case 'C':
+        indexInfo.setX(option.getArgFloat());
+        cornerPipInfo.setX(option.getArgFloat());
+        break;
+
+    case 'I':
+        setIndexDirectory(option.getArg());
+        setPipDirectory(option.getArg());
+        setFaceDirectory(option.getArg());
+        break;
+
+    case 'x': enableDebug(); break;
+
+    default: return help("internal error.");
+    }
+
+    return 0;
+}
+
+
 /**
  * Process command line parameters.
  *
@@ -144,64 +308,110 @@ int Config::parseCommandLine(int argc, char *argv[])
 
     for (const auto & option : optSet)
     {
-        switch (option.getOpt())
-        {
-        case 'H': return help("");
-        case 'v': return version();
+        const int ret{setOption(option)};
+        if (ret)
+            return ret;
+    }
 
-        case 'w': cardWidthPx = option.getArgInt();             break;
-        case 'h': cardHeightPx = option.getArgInt();            break;
-        case 'c': cardColour = option.getArg();                 break;
+    if (!sweep)
+        for (const auto & option : optSet)
+            if ((isSweepOption(option.getOpt())) && (option.getArg().find(':') != std::string::npos))
+                return help("ranges can only be given with --sweep.");
+
+    if ((shards > 1) && ((sweep) || (!makeFilename.empty())))
+        return help("--shard can't be used with --sweep or --makefile.");
+
+    if (isError())
+        return -2;
+
+    return 0;
+}
+
+
+/**
+ * Check if an option can be used to describe a deck in a batch file. The
+ * options that select what is generated apply to the whole batch.
+ *
+ * @param  id - option identifier.
+ * @return true if the option is a deck setting, false otherwise.
+ */
+static bool isDeckOption(int id)
+{
+    switch (id)
+    {
+    case 'H': case 'v': case 's': case 'x':
+    case 16: case 17: case 18: case 19: case 20: case 21: case 23: case 25: case 26: case 28: case 33: case 34: case 35: case 36:
+        return false;
+    }
 
-        case 'i': setIndexDirectory(option.getArg());           break;
-        case 'p': setPipDirectory(option.getArg());             break;
-        case 'f': setFaceDirectory(option.getArg());            break;
+    return true;
+}
 
-        case 's': scriptFilename = option.getArg();             break;
-        case 'o': setOutputDirectory(option.getArg());          break;
 
-        case 'a': keepAspectRatio = true;                       break;
-        case 'm': mpc = true;                                   break;
-        case 'q': quad = true;                                  break;
+/**
+ * Set up the configuration of a deck from a line of the batch file. The deck
+ * starts with the command line settings, which are overridden by those on
+ * the line. Each setting is the long name of an option, followed by "=value"
+ * if the option takes a value.
+ *
+ * @param  argc - command line argument count.
+ * @param  argv - command line argument vector.
+ * @param  line - line of the batch file.
+ * @param  prefix - location of the line, for error messages.
+ * @return error value or 0 if no errors.
+ */
+int Config::parseDeck(int argc, char *argv[], const std::string & line, const std::string & prefix)
+{
+    std::vector<std::string> args{ argv[0] };
+    std::istringstream stream{line};
+    std::string setting{};
+    while (stream >> setting)
+    {
+        const auto pos{setting.find('=')};
+        const std::string option{setting.substr(0, pos)};
+        const auto it{std::find_if(optList.begin(), optList.end(),
+            [&option](const Opt & opt) { return (opt.isName()) && (option == opt.getName()); })};
 
-        case 1:   indexInfo.setH(option.getArgFloat());         break;
-        case 2:   indexInfo.setX(option.getArgFloat());         break;
-        case 3:   indexInfo.setY(option.getArgFloat());         break;
+        if ((it == optList.end()) || (!isDeckOption(it->getIdInt())))
+        {
+            std::cerr << prefix << "\"" << option << "\" is not a deck setting.\n";
 
-        case 4:   cornerPipInfo.setH(option.getArgFloat());     break;
-        case 5:   cornerPipInfo.setX(option.getArgFloat());     break;
-        case 6:   cornerPipInfo.setY(option.getArgFloat());     break;
+            return 1;
+        }
 
-        case 7:   standardPipInfo.setH(option.getArgFloat());   break;
-        case 8:   standardPipInfo.setX(option.getArgFloat());   break;
-        case 9:   standardPipInfo.setY(option.getArgFloat());   break;
+        if (it->isArg() != (pos != std::string::npos))
+        {
+            std::cerr << prefix << "\"" << option << "\" " << (it->isArg() ? "needs a value" : "doesn't take a value") << ".\n";
 
-        case 10:  imageBorderX = option.getArgFloat();          break;
-        case 11:  imageBorderY = option.getArgFloat();          break;
-        case 12:  imagePipInfo.setH(0);                         break;
-        case 13:  imagePipInfo.setH(option.getArgFloat());      break;
-        case 14:  imagePipInfo.setX(option.getArgFloat());      break;
-        case 15:  imagePipInfo.setY(option.getArgFloat());      break;
+            return 1;
+        }
 
-        case 'C':
-            indexInfo.setX(option.getArgFloat());
-            cornerPipInfo.setX(option.getArgFloat());
-            break;
+        args.push_back("--" + option);
+        if (it->isArg())
+            args.push_back(setting.substr(pos + 1));
+    }
 
-        case 'I':
-            setIndexDirectory(option.getArg());
-            setPipDirectory(option.getArg());
-            setFaceDirectory(option.getArg());
-            break;
+    std::vector<char *> deckArgv{};
+    for (auto & arg : args)
+        deckArgv.push_back(arg.data());
 
-        case 'x': enableDebug(); break;
+//- Apply the command line settings, then those of the deck.
+    for (const auto & [count, vector] : { std::make_pair(argc, argv), std::make_pair(int(deckArgv.size()), deckArgv.data()) })
+    {
+        optSet.process(count, vector);
+        if (optSet.isErrors())
+        {
+            std::cerr << prefix << "invalid settings.\n";
 
-        default: return help("internal error.");
+            return 1;
         }
+
+        for (const auto & option : optSet)
+            if (setOption(option))
+                return 1;
     }
 
-    if (isError())
-        return -2;
+    recalculate();
 
     return 0;
 }
@@ -245,53 +455,17 @@ int Config::init(int argc, char *argv[])
 }
 
 /**
- * Recalculate global variables using command line input.
+ * Fill in the settings that default to values derived from other settings.
+ * The values used to lay out the cards are calculated by RenderContext.
  */
 void Config::recalculate(void)
 {
-//- Set up for Make Playing Cards output requirements.
-    if (mpc)
-    {
-        cardWidthPx  = mpcWidth;
-        cardHeightPx = mpcHeight;
-        cardBorderPx = mpcBorder;
-        cornerRadius = 0.0;
-    }
-
-//- Card outline values in pixels.
-    radius = ROUND(cornerRadius * cardHeightPx / 100);
-    outlineWidth = cardWidthPx-borderOffset-1;
-    outlineHeight = cardHeightPx-borderOffset-1;
-
-//- Calculate viewport window size as percentages of the card size. In this
-//  context the viewport is the area of the card not occupied by the standard
-//  pip borders.
-    viewportWindowX = (100.0F - (2.0F * standardPipInfo.getX()));
-    viewportWindowY = (100.0F - (2.0F * standardPipInfo.getY()));
-
-//- Card face image values in pixels.
-    imageWidth  = 100 - (2 * imageBorderX);
-    imageHeight = 50 - imageBorderY;
-    imageWidthPx    = ROUND(imageWidth * cardWidthPx / 100);
-    imageHeightPx   = ROUND(imageHeight * cardHeightPx / 100);
-    imageOffsetXPx  = ROUND(imageBorderX * cardWidthPx / 100);
-    imageOffsetYPx  = ROUND(imageBorderY * cardHeightPx / 100);
-
-    const float scaleX{imageWidth/originalImageWidth};
-    const float scaleY{imageHeight/originalImageHeight};
-    imagePipScale = (scaleX < scaleY) ? scaleX : scaleY;
-
-    imageX      = 50;
-    imageY      = imageBorderY + (imageHeight / 2);
-
 //- If "outputDirectory" isn't explicitly set, use "face".
     if (!outputDirectory.length())
     {
         std::filesystem::path path{faceDirectory.substr(0, faceDirectory.length()-1)};
         setOutputDirectory(path.filename().string());
     }
-
-    PatternCollection::calibrate(viewportWindowX, viewportWindowY);
 }
 
 std::string Config::makeIndexPath(std::string value)
@@ -372,37 +546,194 @@ void Config::display(std::ostream &os) const
 	os << "\n";
 	os << "scriptFilename\t" << scriptFilename << "\n";
 	os << "refreshFilename\t" << refreshFilename << "\n";
+	os << "makeFilename\t" << makeFilename << "\n";
+	os << "cacheDirectory\t" << cacheDirectory << "\n";
+	os << "batchFilename\t" << batchFilename << "\n";
 	os << "outputDirectory\t" << outputDirectory << "\n";
 	os << "\n";
 	os << "keepAspectRatio\t" << keepAspectRatio << "\n";
 	os << "MPC\t\t" << mpc << "\n";
 	os << "Quad\t\t" << quad << "\n";
-	os << "\n";
-	os << "cornerRadius\t" << cornerRadius << "\n";
-	os << "radius\t\t" << radius << "\n";
-	os << "strokeWidth\t" << strokeWidth << "\n";
-	os << "borderOffset\t" << borderOffset << "\n";
-	os << "outlineWidth\t" << outlineWidth << "\n";
-	os << "outlineHeight\t" << outlineHeight << "\n";
+	os << "render\t\t" << render << "\n";
+	os << "buildIndex\t" << buildIndex << "\n";
+	os << "layers\t\t" << layers << "\n";
+	os << "mpr\t\t" << mpr << "\n";
+	os << "mirror\t\t" << mirror << "\n";
+	os << "sweep\t\t" << sweep << "\n";
+	os << "filter\t\t" << Resample::getFilterName(filter) << "\n";
+	os << "spriteCache\t" << spriteCache << "\n";
+	os << "colours\t\t" << colours << "\n";
+	os << "dither\t\t" << Quantize::getDitherName(dither) << "\n";
+	os << "sharedPalette\t" << sharedPalette << "\n";
+	os << "pngLevel\t" << PngWriter::getLevelName(pngLevel) << "\n";
+	os << "incremental\t" << incremental << "\n";
+	os << "resume\t\t" << resume << "\n";
+	os << "shard\t\t" << shard << "/" << shards << "\n";
+	os << "cards\t\t" << cards.size() << "\n";
+	os << "jobs\t\t" << jobs << "\n";
+	os << "retries\t\t" << retries << "\n";
 	os << "\n";
 	os << "imageBorderX\t" << imageBorderX << "\n";
 	os << "imageBorderY\t" << imageBorderY << "\n";
-	os << "originalImageWidth\t" << originalImageWidth << "\n";
-	os << "originalImageHeight\t" << originalImageHeight << "\n";
 	os << "\n";
-	os << "viewportWindowX\t" << viewportWindowX << "\n";
-	os << "viewportWindowY\t" << viewportWindowY << "\n";
-	os << "\n";
-	os << "imageWidth\t" << imageWidth << "\n";
-	os << "imageHeight\t" << imageHeight << "\n";
-	os << "imageWidthPx\t" << imageWidthPx << "\n";
-	os << "imageHeightPx\t" << imageHeightPx << "\n";
-	os << "imageOffsetXPx\t" << imageOffsetXPx << "\n";
-	os << "imageOffsetYPx\t" << imageOffsetYPx << "\n";
-	os << "\n";
-	os << "imagePipScale\t" << imagePipScale << "\n";
-	os << "imageX\t\t" << imageX << "\n";
-	os << "imageY\t\t" << imageY << "\n";
+	os << RenderContext{*this};
+}
+
+
+/**
+ * Get the context of each deck to generate. This is the deck described by
+ * the command line, unless a batch file is given, in which case there is a
+ * deck for each line of the batch file that isn't blank or a comment.
+ *
+ * @param  argc - command line argument count.
+ * @param  argv - command line argument vector.
+ * @param  decks - the context of each deck.
+ * @return error value or 0 if no errors.
+ */
+int Config::getDecks(int argc, char *argv[], std::vector<RenderContext> & decks)
+{
+    if (!isBatch())
+    {
+        decks.emplace_back(instance());
+
+        return 0;
+    }
+
+    const auto batchFilename{getBatchFilename()};
+    std::ifstream file{batchFilename.c_str()};
+    if (!file)
+    {
+        std::cerr << "Can't open batch file " << batchFilename << " - aborting!\n";
+
+        return 1;
+    }
+
+    std::set<std::string> outputDirectories{};
+    std::string line{};
+    for (int number{1}; std::getline(file, line); ++number)
+    {
+        const auto first{line.find_first_not_of(" \t\r")};
+        if ((first == std::string::npos) || (line[first] == '#'))
+            continue;
+
+        const std::string prefix{batchFilename + ":" + std::to_string(number) + ": "};
+        Config deck{};
+        if (deck.parseDeck(argc, argv, line, prefix))
+            return 1;
+
+        if (!deck.check(true, prefix))
+            return 1;
+
+        if (!outputDirectories.insert(deck.outputDirectory).second)
+        {
+            std::cerr << prefix << "Output directory \"" << deck.outputDirectory << "\" is used by an earlier deck.\n";
+
+            return 1;
+        }
+
+        decks.emplace_back(deck);
+    }
+
+    if (decks.empty())
+    {
+        std::cerr << "Batch file " << batchFilename << " doesn't describe any decks.\n";
+
+        return 1;
+    }
+
+    return 0;
+}
+
+
+/**
+ * Parse a range given to --sweep as "start:end:step", or as "start:end"
+ * which uses a step of 1.
+ *
+ * @param  range - range to parse.
+ * @param  values - set to the values in the range.
+ * @return true if the range is valid, false otherwise.
+ */
+static bool parseRange(const std::string & range, std::vector<float> & values)
+{
+    std::istringstream stream{range};
+    float start{};
+    float end{};
+    float step{1};
+    char colon{};
+    if ((!(stream >> start >> colon >> end)) || (colon != ':'))
+        return false;
+
+    if ((stream >> colon) && ((colon != ':') || (!(stream >> step))))
+        return false;
+
+    if ((!stream.eof()) || (step <= 0) || (end < start))
+        return false;
+
+    const int count{int(((end - start) / step) + 0.001F) + 1};
+    for (int i{}; i < count; ++i)
+        values.push_back(start + (i * step));
+
+    return true;
+}
+
+
+/**
+ * Get the context of each combination of the ranges given with --sweep.
+ * The combinations are ordered with the values of the last setting given
+ * changing fastest.
+ *
+ * @param  argc - command line argument count.
+ * @param  argv - command line argument vector.
+ * @param  sweeps - the settings being varied and their values.
+ * @param  decks - the context of each combination.
+ * @return error value or 0 if no errors.
+ */
+int Config::getSweep(int argc, char *argv[], std::vector<Sweep> & sweeps, std::vector<RenderContext> & decks)
+{
+    optSet.process(argc, argv);
+    for (const auto & option : optSet)
+    {
+        if ((!isSweepOption(option.getOpt())) || (option.getArg().find(':') == std::string::npos))
+            continue;
+
+        Sweep range{option.getLong(), {}};
+        if (!parseRange(option.getArg(), range.values))
+        {
+            std::cerr << "Invalid range \"" << option.getArg() << "\" for --" << range.name << ".\n";
+
+            return 1;
+        }
+
+        sweeps.push_back(range);
+    }
+
+    if (sweeps.empty())
+    {
+        std::cerr << "--sweep needs at least one range, for example --IndexHeight 9:12:0.5.\n";
+
+        return 1;
+    }
+
+//- Set up a deck for each combination, as if it were a line of a batch file.
+    std::vector<size_t> index(sweeps.size(), 0);
+    for (size_t i{sweeps.size()}; i > 0; )
+    {
+        std::ostringstream line{};
+        for (size_t j{}; j < sweeps.size(); ++j)
+            line << sweeps[j].name << "=" << sweeps[j].values[index[j]] << " ";
+
+        Config deck{};
+        if (deck.parseDeck(argc, argv, line.str(), "--sweep: "))
+            return 1;
+
+        decks.emplace_back(deck);
+
+        // Move on to the next combination.
+        for (i = sweeps.size(); (i > 0) && (++index[i-1] == sweeps[i-1].values.size()); --i)
+            index[i-1] = 0;
+    }
+
+    return 0;
 }
 
 
@@ -410,36 +741,34 @@ void Config::display(std::ostream &os) const
  * @brief Validate the configuration.
  * 
  * @param showErrors flag to indicate if errors should be displayed.
+ * @param prefix location of the configuration, for error messages.
  * @return true if configuration is valid, false otherwise.
  */
-bool Config::isValid(bool showErrors)
+bool Config::check(bool showErrors, const std::string & prefix) const
 {
-    if (!std::filesystem::exists(getIndexDirectory()))
+    if (!std::filesystem::exists(indexDirectory))
     {
         if (showErrors)
-            std::cerr << "\nIndex directory \"" << getIndexDirectory() << "\" does not exist.\n";
+            std::cerr << "\n" << prefix << "Index directory \"" << indexDirectory << "\" does not exist.\n";
         
         return false;
     }
 
-    if (!std::filesystem::exists(getPipDirectory()))
+    if (!std::filesystem::exists(pipDirectory))
     {
         if (showErrors)
-            std::cerr << "\nPip directory \"" << getPipDirectory() << "\" does not exist.\n";
+            std::cerr << "\n" << prefix << "Pip directory \"" << pipDirectory << "\" does not exist.\n";
 
         return false;
     }
 
-    if (!std::filesystem::exists(getFaceDirectory()))
+    if (!std::filesystem::exists(faceDirectory))
     {
         if (showErrors)
-            std::cerr << "\nFace directory \"" << getFaceDirectory() << "\" does not exist.\n";
+            std::cerr << "\n" << prefix << "Face directory \"" << faceDirectory << "\" does not exist.\n";
 
         return false;
     }
 
     return true;
 }
-
-
-
@@ -34,6 +34,17 @@
 
 #include "config.h"
 #include "cardgen.h"
+#include "Opts.h"
+
+
+/**
+ * A layout setting varied by --sweep and the values it takes.
+ */
+struct Sweep
+{
+    std::string name;
+    std::vector<float> values;
+};
 
 
 /**
@@ -61,36 +72,36 @@ private:
 
         scriptFilename{_scriptFilename},
         refreshFilename{_refreshFilename},
+        makeFilename{},
+        cacheDirectory{},
+        batchFilename{},
         outputDirectory{},
 
         keepAspectRatio{_keepAspectRatio},
         mpc{_mpc},
         quad{_quad},
-
-        cornerRadius{_cornerRadius},
-        radius{},
-        strokeWidth{_strokeWidth},
-        borderOffset{_borderOffset},
-        outlineWidth{},
-        outlineHeight{},
+        render{},
+        jobs{},
+        buildIndex{},
+        layers{},
+        mpr{},
+        mirror{},
+        sweep{},
+        filter{_filter},
+        spriteCache{_spriteCache},
+        colours{_colours},
+        dither{_dither},
+        sharedPalette{},
+        pngLevel{_pngLevel},
+        incremental{},
+        resume{},
+        shard{1},
+        shards{1},
+        cards{},
+        retries{_retries},
 
         imageBorderX{_imageBorderX},
         imageBorderY{_imageBorderY},
-        originalImageWidth{100 - (2 * imageBorderX)},
-        originalImageHeight{50 - imageBorderY},
-
-        viewportWindowX{},
-        viewportWindowY{},
-
-        imageWidth{},
-        imageHeight{},
-        imageWidthPx{},
-        imageHeightPx{},
-        imageOffsetXPx{},
-        imageOffsetYPx{},
-        imagePipScale{},
-        imageX{},
-        imageY{},
 
         debug{}, error{}
         {  }
@@ -114,36 +125,36 @@ private:
 
     std::string scriptFilename;
     std::string refreshFilename;
+    std::string makeFilename;
+    std::string cacheDirectory;
+    std::string batchFilename;
     std::string outputDirectory;
 
     bool keepAspectRatio;
     bool mpc;
     bool quad;
-
-    float cornerRadius;
-    int radius;
-    int strokeWidth;
-    int borderOffset;
-    int outlineWidth;
-    int outlineHeight;
+    bool render;
+    int jobs;
+    bool buildIndex;
+    bool layers;
+    bool mpr;
+    bool mirror;
+    bool sweep;
+    Resample::Filter filter;
+    int spriteCache;
+    int colours;
+    Quantize::Dither dither;
+    bool sharedPalette;
+    PngWriter::Level pngLevel;
+    bool incremental;
+    bool resume;
+    int shard;
+    int shards;
+    std::vector<std::string> cards;
+    int retries;
 
     float imageBorderX;
     float imageBorderY;
-    float originalImageWidth;
-    float originalImageHeight;
-
-    float viewportWindowX;
-    float viewportWindowY;
-
-    float imageWidth;
-    float imageHeight;
-    int imageWidthPx;
-    int imageHeightPx;
-    int imageOffsetXPx;
-    int imageOffsetYPx;
-    float imagePipScale;
-    float imageX;
-    float imageY;
 
     std::string name;
     bool debug;
@@ -163,7 +174,10 @@ private:
 
     int version(void) const;
     int help(const std::string & error) const;
+    int setOption(const Arg & option);
     int parseCommandLine(int argc, char *argv[]);
+    int parseDeck(int argc, char *argv[], const std::string & line, const std::string & prefix);
+    bool check(bool showErrors, const std::string & prefix) const;
     int initialise(int argc, char *argv[]);
 
 public:
@@ -174,24 +188,22 @@ public:
     int init(int argc, char *argv[]);
     void recalculate(void);
     friend std::ostream & operator<<(std::ostream &os, const Config &A) { A.display(os); return os; }
+    friend class RenderContext;
 
     static Config & instance() { static Config neo; return neo; }
 
-    static void setImageBorderX(float v) { instance().imageBorderX = v; }
-    static void setImageBorderY(float v) { instance().imageBorderY = v; }
-
     static int getCardWidthPx(void) { return instance().cardWidthPx; }
     static int getCardHeightPx(void) { return instance().cardHeightPx; }
     static int getCardBorderPx(void) { return instance().cardBorderPx; }
     static std::string getCardColour(void) { return instance().cardColour; }
 
-    static info & getIndexInfo(void) { return instance().indexInfo; }
-    static info & getCornerPipInfo(void) { return instance().cornerPipInfo; }
-    static info & getStandardPipInfo(void) { return instance().standardPipInfo; }
+    static const info & getIndexInfo(void) { return instance().indexInfo; }
+    static const info & getCornerPipInfo(void) { return instance().cornerPipInfo; }
+    static const info & getStandardPipInfo(void) { return instance().standardPipInfo; }
     static float getStandardPipH(void) { return instance().standardPipInfo.getH(); }
     static float getStandardPipX(void) { return instance().standardPipInfo.getX(); }
     static float getStandardPipY(void) { return instance().standardPipInfo.getY(); }
-    static info & getImagePipInfo(void) { return instance().imagePipInfo; }
+    static const info & getImagePipInfo(void) { return instance().imagePipInfo; }
     static float getImagePipH(void) { return instance().imagePipInfo.getH(); }
     static float getImagePipX(void) { return instance().imagePipInfo.getX(); }
     static float getImagePipY(void) { return instance().imagePipInfo.getY(); }
@@ -202,40 +214,41 @@ public:
 
     static std::string getScriptFilename(void) { return instance().scriptFilename; }
     static std::string getRefreshFilename(void) { return instance().refreshFilename; }
+    static std::string getMakeFilename(void) { return instance().makeFilename; }
+    static bool isMakefile(void) { return !instance().makeFilename.empty(); }
+    static std::string getCacheDirectory(void) { return instance().cacheDirectory; }
+    static bool isCache(void) { return !instance().cacheDirectory.empty(); }
+    static std::string getBatchFilename(void) { return instance().batchFilename; }
+    static bool isBatch(void) { return !instance().batchFilename.empty(); }
     static std::string getOutputDirectory(void) { return instance().outputDirectory; }
 
     static bool isKeepAspectRatio(void) { return instance().keepAspectRatio; }
     static bool isMpc(void) { return instance().mpc; }
     static bool isQuad(void) { return instance().quad; }
-
-    static float getCornerRadius(void) { return instance().cornerRadius; }
-    static int getRadius(void) { return instance().radius; }
-    static int getStrokeWidth(void) { return instance().strokeWidth; }
-    static int getBorderOffset(void) { return instance().borderOffset; }
-    static int getOutlineWidth(void) { return instance().outlineWidth; }
-    static int getOutlineHeight(void) { return instance().outlineHeight; }
+    static bool isRender(void) { return instance().render; }
+    static bool isBuildIndex(void) { return instance().buildIndex; }
+    static bool isLayers(void) { return instance().layers; }
+    static bool isMpr(void) { return instance().mpr; }
+    static bool isMirror(void) { return instance().mirror; }
+    static bool isSweep(void) { return instance().sweep; }
+    static Resample::Filter getFilter(void) { return instance().filter; }
+    static int getSpriteCache(void) { return instance().spriteCache; }
+    static bool isIncremental(void) { return instance().incremental; }
+    static bool isResume(void) { return instance().resume; }
+    static int getShard(void) { return instance().shard; }
+    static int getShards(void) { return instance().shards; }
+    static bool isJobs(void) { return instance().jobs > 0; }
+    static int getJobs(void) { return instance().jobs; }
+    static int getRetries(void) { return instance().retries; }
 
     static float getImageBorderX(void) { return instance().imageBorderX; }
     static float getImageBorderY(void) { return instance().imageBorderY; }
-    static float getOriginalImageWidth(void) { return instance().originalImageWidth; }
-    static float getOriginalImageHeight(void) { return instance().originalImageHeight; }
-
-    static float getViewportWindowX(void) { return instance().viewportWindowX; }
-    static float getViewportWindowY(void) { return instance().viewportWindowY; }
-
-    static float getImageWidth(void) { return instance().imageWidth; }
-    static float getImageHeight(void) { return instance().imageHeight; }
-    static int getImageWidthPx(void) { return instance().imageWidthPx; }
-    static int getImageHeightPx(void) { return instance().imageHeightPx; }
-    static int getImageOffsetXPx(void) { return instance().imageOffsetXPx; }
-    static int getImageOffsetYPx(void) { return instance().imageOffsetYPx; }
-    static float getImagePipScale(void) { return instance().imagePipScale; }
-    static float getImageX(void) { return instance().imageX; }
-    static float getImageY(void) { return instance().imageY; }
 
     static bool isName(void) { return !instance().name.empty(); }
     static std::string & getName(void) { return instance().name; }
-    static bool isValid(bool showErrors = false);
+    static bool isValid(bool showErrors = false) { return instance().check(showErrors, ""); }
+    static int getDecks(int argc, char *argv[], std::vector<RenderContext> & decks);
+    static int getSweep(int argc, char *argv[], std::vector<Sweep> & sweeps, std::vector<RenderContext> & decks);
     static bool isDebug(void) { return instance().debug; }
     static bool isError(void) { return instance().error != 0; }
     static int getError(void) { return instance().error; }
@@ -0,0 +1,198 @@
+/**
+ * @file    Hash.cpp
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'cardgen' is a playing card image generator.
+ *
+ * Implementation for the Hash class, a SHA-256 implementation.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+
+#include "Hash.h"
+
+
+/**
+ * @section Internal constants and variables.
+ *
+ */
+
+static const uint32_t k[64]{
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+
+};
+
+static std::mutex fileMutex{};
+static std::map<std::string, std::string> fileHashes{};
+
+
+/**
+ * @section Hash class method code.
+ *
+ */
+
+static inline uint32_t rotr(uint32_t v, int n) { return (v >> n) | (v << (32 - n)); }
+
+Hash::Hash(void) :
+    state{ 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 },
+    block{}, used{}, length{}
+{ }
+
+/**
+ * Process a single 64 byte block.
+ *
+ * @param  data - the block to process.
+ */
+void Hash::transform(const uint8_t * data)
+{
+    uint32_t w[64];
+    for (int i{}; i < 16; ++i)
+        w[i] = (uint32_t(data[i*4]) << 24) | (uint32_t(data[i*4+1]) << 16) | (uint32_t(data[i*4+2]) << 8) | data[i*4+3];
+
+    for (int i{16}; i < 64; ++i)
+    {
+        const uint32_t s0{rotr(w[i-15], 7) ^ rotr(w[i-15], 18) ^ (w[i-15] >> 3)};
+        const uint32_t s1{rotr(w[i-2], 17) ^ rotr(w[i-2], 19) ^ (w[i-2] >> 10)};
+        w[i] = w[i-16] + s0 + w[i-7] + s1;
+    }
+
+    uint32_t a{state[0]}, b{state[1]}, c{state[2]}, d{state[3]};
+    uint32_t e{state[4]}, f{state[5]}, g{state[6]}, h{state[7]};
+    for (int i{}; i < 64; ++i)
+    {
+        const uint32_t t1{h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + k[i] + w[i]};
+        const uint32_t t2{(rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c))};
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+/**
+ * Add data to the digest.
+ *
+ * @param  data - data to add.
+ * @param  size - number of bytes to add.
+ * @return the Hash object to allow chaining.
+ */
+Hash & Hash::update(const void * data, size_t size)
+{
+    const uint8_t * bytes{static_cast<const uint8_t *>(data)};
+    length += size;
+
+    while (size)
+    {
+        const size_t count{std::min(size, sizeof(block) - used)};
+        std::memcpy(block + used, bytes, count);
+        used += count;
+        bytes += count;
+        size -= count;
+
+        if (used == sizeof(block))
+        {
+            transform(block);
+            used = 0;
+        }
+    }
+
+    return *this;
+}
+
+/**
+ * Complete the digest.
+ *
+ * @return the digest as a string of hex digits.
+ */
+std::string Hash::digest(void)
+{
+    const uint64_t bits{length * 8};
+    const uint8_t pad{0x80};
+    update(&pad, 1);
+
+    const uint8_t zero{};
+    while (used != 56)
+        update(&zero, 1);
+
+    uint8_t size[8];
+    for (int i{}; i < 8; ++i)
+        size[i] = uint8_t(bits >> (56 - (i * 8)));
+    update(size, 8);
+
+    static const char hex[]{"0123456789abcdef"};
+    std::string output{};
+    for (const auto v : state)
+        for (int i{28}; i >= 0; i -= 4)
+            output += hex[(v >> i) & 0xF];
+
+    return output;
+}
+
+/**
+ * Generate the digest of the contents of a file. Each file is only read
+ * once per run.
+ *
+ * @param  fileName - name of file.
+ * @return the digest, or an empty string if the file can't be read.
+ */
+std::string Hash::file(const std::string & fileName)
+{
+    {
+        std::lock_guard<std::mutex> lock{fileMutex};
+        auto it{fileHashes.find(fileName)};
+        if (it != fileHashes.end())
+            return it->second;
+    }
+
+    std::string output{};
+    std::ifstream file{fileName, std::ifstream::in|std::ifstream::binary};
+    if (file)
+    {
+        Hash hash{};
+        char buffer[65536];
+        while (file.read(buffer, sizeof(buffer)) || (file.gcount()))
+            hash.update(buffer, file.gcount());
+
+        output = hash.digest();
+    }
+
+    std::lock_guard<std::mutex> lock{fileMutex};
+    fileHashes[fileName] = output;
+
+    return output;
+}
+
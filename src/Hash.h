@@ -0,0 +1,62 @@
+/**
+ * @file    Hash.h
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'cardgen' is a playing card image generator.
+ *
+ * Interface for the Hash class, a SHA-256 implementation.
+ */
+
+#if !defined _HASH_H_INCLUDED_
+#define _HASH_H_INCLUDED_
+
+#include <cstdint>
+#include <string>
+
+
+/**
+ * @section Hash class.
+ *
+ * Used to generate SHA-256 digests of strings and files.
+ */
+class Hash
+{
+private:
+    uint32_t state[8];
+    uint8_t block[64];
+    size_t used;
+    uint64_t length;
+
+    void transform(const uint8_t * data);
+
+public:
+    Hash(void);
+
+    Hash & update(const void * data, size_t size);
+    Hash & update(const std::string & value) { return update(value.data(), value.size()); }
+    std::string digest(void);
+
+    static std::string string(const std::string & value) { return Hash{}.update(value).digest(); }
+    static std::string file(const std::string & fileName);
+
+};
+
+
+#endif //!defined _HASH_H_INCLUDED_
+
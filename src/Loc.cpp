@@ -77,20 +77,20 @@ const std::vector<Loc_s> Pattern::locs{
 
 };
 
-std::vector<Loc> Pattern::locations{};
-
-void Pattern::init(float viewportWindowX, float viewportWindowY)
+Pattern::Container Pattern::genLocations(float viewportWindowX, float viewportWindowY)
 {
-    locations.clear();
+    Container locations{};
     for (const Loc_s & loc : locs)
         locations.emplace_back(loc, viewportWindowX, viewportWindowY);
+
+    return locations;
 }
 
-Pattern::Pattern(const std::vector<Index> & v)
+Pattern::Pattern(const std::vector<Index> & v, const Container & locations)
 {
     for (auto index : v)
     {
-        if (isIndex(index))
+        if (index < locations.size())
         {
             const auto & location{locations.at(index)};
             if (location.isRotate())
@@ -126,18 +126,10 @@ const std::vector<std::vector<size_t>> PatternCollection::pats{
 
 };
 
-PatternCollection::Container PatternCollection::patterns{};
-
-void PatternCollection::init(void)
+PatternCollection::PatternCollection(float viewportWindowX, float viewportWindowY) : patterns{}
 {
-    patterns.clear();
+    const auto locations{Pattern::genLocations(viewportWindowX, viewportWindowY)};
     for (auto pattern : pats)
-        patterns.emplace_back(pattern);
-}
-
-void PatternCollection::calibrate(float viewportWindowX, float viewportWindowY)
-{
-    Pattern::init(viewportWindowX, viewportWindowY);
-    PatternCollection::init();
+        patterns.emplace_back(pattern, locations);
 }
 
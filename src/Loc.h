@@ -85,24 +85,18 @@ public:
 
 private:
     static const std::vector<Loc_s> locs;
-    static std::vector<Loc> locations;
 
     Pairs   northern;
     Pairs   southern;
     bool    rotate;
 
-    static const Loc & getSafeLoc(Index loc)
-        { return isIndex(loc) ? locations.at(loc) : locations.at(0); }
-
 public:
-    Pattern(const std::vector<Index> & v);
-    static void init(float viewportWindowX, float viewportWindowY);
+    Pattern(const std::vector<Index> & v, const Container & locations);
+    static Container genLocations(float viewportWindowX, float viewportWindowY);
 
     const Iterator begin(void) const { return rotate ? southern.begin() : northern.begin(); }
     const Iterator end(void) const { return rotate ? southern.end() : northern.end(); }
 
-    static bool isIndex(Index index) { return index < locations.size(); }
-
     bool isRotate(void) const { return rotate; }
 
     void setRotate(bool state) { rotate = state; }
@@ -113,6 +107,8 @@ public:
 /**
  * @section PatternCollection class code.
  *
+ * Each collection is calibrated for a single viewport size, so collections
+ * for different card sizes can be used at the same time.
  */
 
 class PatternCollection
@@ -123,20 +119,17 @@ public:
 
 private:
     static const std::vector<std::vector<size_t>> pats;
-    static Container patterns;
+    Container patterns;
 
-    static const Pattern & getSafePat(Index pat)
+    const Pattern & getSafePat(Index pat) const
         { return isIndex(pat) ? patterns.at(pat) : patterns.at(0); }
 
-    static void init(void);
-
 public:
-    PatternCollection(void) { }
-
-    static void calibrate(float viewportWindowX, float viewportWindowY);
+    PatternCollection(void) : patterns{} { }
+    PatternCollection(float viewportWindowX, float viewportWindowY);
 
-    static bool isIndex(Index index) { return index < patterns.size(); }
-    static const Pattern & getPattern(Index pat) { return getSafePat(pat); }
+    bool isIndex(Index index) const { return index < patterns.size(); }
+    const Pattern & getPattern(Index pat) const { return getSafePat(pat); }
 
 };
 
@@ -0,0 +1,628 @@
+/**
+ * @file    PngReader.cpp
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'cardgen' is a playing card image generator.
+ *
+ * Implementation for the PngReader class.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <zlib.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "PngReader.h"
+
+
+/**
+ * @section Internal constants and variables.
+ *
+ */
+
+static const uint8_t signature[8]{ 137, 'P', 'N', 'G', '\r', '\n', 26, '\n' };
+
+enum Filter { NONE, SUB, UP, AVERAGE, PAETH };
+
+/**
+ * The layout of the image data and the colours it refers to.
+ */
+struct Format
+{
+    int width;
+    int height;
+    int depth;
+    int colourType;
+    size_t channels;
+    std::array<std::array<uint8_t, 4>, 256> palette;
+    int key[3];
+};
+
+/**
+ * A read only memory mapping of a file, which is unmapped when destroyed.
+ */
+class Mapping
+{
+private:
+    const uint8_t * data;
+    size_t size;
+
+public:
+    explicit Mapping(const std::string & fileName);
+    ~Mapping(void) { if (data) munmap(const_cast<uint8_t *>(data), size); }
+    Mapping(const Mapping &) = delete;
+    void operator=(const Mapping &) = delete;
+
+    const uint8_t * getData(void) const { return data; }
+    size_t getSize(void) const { return size; }
+
+};
+
+/**
+ * Constructor. Map the whole of a file into memory.
+ *
+ * @param  fileName - name of file to map.
+ */
+Mapping::Mapping(const std::string & fileName) : data{}, size{}
+{
+    const int fd{open(fileName.c_str(), O_RDONLY|O_CLOEXEC)};
+    if (fd < 0)
+        return;
+
+    struct stat st{};
+    void * map{MAP_FAILED};
+    if ((fstat(fd, &st) == 0) && (st.st_size > 0))
+        map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (map == MAP_FAILED)
+        return;
+
+    data = static_cast<const uint8_t *>(map);
+    size = st.st_size;
+}
+
+
+/**
+ * @section Internal support code.
+ *
+ */
+
+static inline uint32_t div255(uint32_t v)
+{
+    v += 128;
+    return (v + (v >> 8)) >> 8;
+}
+
+/**
+ * Get a 4 byte big-endian value.
+ *
+ * @param  p - first byte of the value.
+ * @return the value.
+ */
+static uint32_t getInt(const uint8_t * p)
+{
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+}
+
+/**
+ * Get a sample from a row of image data.
+ *
+ * @param  row - unfiltered row.
+ * @param  index - index of the sample in the row.
+ * @param  depth - bits per sample.
+ * @return the sample.
+ */
+static int getSample(const uint8_t * row, size_t index, int depth)
+{
+    if (depth == 8)
+        return row[index];
+
+    if (depth == 16)
+        return (row[index * 2] << 8) | row[(index * 2) + 1];
+
+    const size_t bit{index * depth};
+    const int shift{8 - depth - int(bit % 8)};
+
+    return (row[bit / 8] >> shift) & ((1 << depth) - 1);
+}
+
+/**
+ * Scale a sample to 8 bits, as libpng does.
+ *
+ * @param  sample - the sample.
+ * @param  depth - bits per sample.
+ * @return the 8 bit value.
+ */
+static uint8_t scaleSample(int sample, int depth)
+{
+    if (depth == 16)
+        return uint8_t(((sample * 255) + 32895) >> 16);
+
+    return uint8_t(sample * 255 / ((1 << depth) - 1));
+}
+
+#if defined(__SSE2__)
+static inline __m128i load4(const uint8_t * p) { int32_t v; std::memcpy(&v, p, 4); return _mm_cvtsi32_si128(v); }
+static inline void store4(uint8_t * p, __m128i v) { const int32_t value{_mm_cvtsi128_si32(v)}; std::memcpy(p, &value, 4); }
+
+/**
+ * Undo the Sub, Average or Paeth filter for 3 or 4 byte pixels, a pixel at
+ * a time as each depends on the one to its left. 4 bytes are always loaded
+ * and stored, so the rows need a byte of padding for 3 byte pixels. The
+ * predictor of the byte past a 3 byte pixel is kept at zero so that the
+ * byte is stored unchanged.
+ *
+ * @param  filter - filter to undo.
+ * @param  row - filtered row, unfiltered in place.
+ * @param  prior - unfiltered previous row.
+ * @param  size - number of bytes in a row.
+ */
+template <size_t bpp>
+static void unfilterPixels(int filter, uint8_t * row, const uint8_t * prior, size_t size)
+{
+    const __m128i zero{_mm_setzero_si128()};
+    const __m128i mask{_mm_cvtsi32_si128((bpp == 4) ? -1 : 0xFFFFFF)};
+    const auto load{[&mask](const uint8_t * p) { return _mm_and_si128(load4(p), mask); }};
+    __m128i a{zero};
+    __m128i c{zero};
+    __m128i x{load4(row)};
+    for (size_t i{}; i + bpp <= size; i += bpp)
+    {
+        if (filter == SUB)
+            a = _mm_add_epi8(x, a);
+        else
+        if (filter == AVERAGE)
+        {
+            const __m128i b{load(prior + i)};
+            const __m128i average{_mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), _mm_set1_epi8(1)))};
+            a = _mm_add_epi8(x, average);
+        }
+        else
+        {
+            const __m128i b{_mm_unpacklo_epi8(load(prior + i), zero)};
+            const __m128i a16{_mm_unpacklo_epi8(a, zero)};
+            const __m128i bc{_mm_sub_epi16(b, c)};
+            const __m128i ac{_mm_sub_epi16(a16, c)};
+            const __m128i abc{_mm_add_epi16(bc, ac)};
+            const __m128i pa{_mm_max_epi16(bc, _mm_sub_epi16(zero, bc))};
+            const __m128i pb{_mm_max_epi16(ac, _mm_sub_epi16(zero, ac))};
+            const __m128i pc{_mm_max_epi16(abc, _mm_sub_epi16(zero, abc))};
+            const __m128i notA{_mm_or_si128(_mm_cmpgt_epi16(pa, pb), _mm_cmpgt_epi16(pa, pc))};
+            const __m128i useC{_mm_cmpgt_epi16(pb, pc)};
+            const __m128i notAValue{_mm_or_si128(_mm_and_si128(useC, c), _mm_andnot_si128(useC, b))};
+            const __m128i predictor{_mm_or_si128(_mm_and_si128(notA, notAValue), _mm_andnot_si128(notA, a16))};
+            a = _mm_add_epi8(x, _mm_packus_epi16(predictor, zero));
+            c = b;
+        }
+        // Load the next pixel before storing this one, as a load that
+        // overlaps a pending store has to wait for it.
+        const __m128i next{(i + bpp + bpp <= size) ? load4(row + i + bpp) : zero};
+        store4(row + i, a);
+        a = _mm_and_si128(a, mask);
+        x = next;
+    }
+}
+#endif
+
+/**
+ * Undo the filter of a row of image data.
+ *
+ * @param  filter - filter to undo.
+ * @param  row - filtered row, unfiltered in place.
+ * @param  prior - unfiltered previous row, all zeros for the first row.
+ * @param  size - number of bytes in a row, excluding a byte of padding.
+ * @param  bpp - number of bytes per pixel, rounded up to 1.
+ * @return true if the filter is valid, false otherwise.
+ */
+static bool unfilterRow(int filter, uint8_t * row, const uint8_t * prior, size_t size, size_t bpp)
+{
+    if (filter > PAETH)
+        return false;
+
+    if (filter == NONE)
+        return true;
+
+    if (filter == UP)
+    {
+        size_t i{};
+#if defined(__SSE2__)
+        for (; i + 16 <= size; i += 16)
+        {
+            const __m128i x{_mm_loadu_si128(reinterpret_cast<const __m128i *>(row + i))};
+            const __m128i b{_mm_loadu_si128(reinterpret_cast<const __m128i *>(prior + i))};
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(row + i), _mm_add_epi8(x, b));
+        }
+#elif defined(__ARM_NEON)
+        for (; i + 16 <= size; i += 16)
+            vst1q_u8(row + i, vaddq_u8(vld1q_u8(row + i), vld1q_u8(prior + i)));
+#endif
+        for (; i < size; ++i)
+            row[i] = uint8_t(row[i] + prior[i]);
+
+        return true;
+    }
+
+#if defined(__SSE2__)
+    if (bpp == 4)
+    {
+        unfilterPixels<4>(filter, row, prior, size);
+
+        return true;
+    }
+
+    if (bpp == 3)
+    {
+        unfilterPixels<3>(filter, row, prior, size);
+
+        return true;
+    }
+#endif
+
+    for (size_t i{}; i < size; ++i)
+    {
+        const int a{(i >= bpp) ? row[i-bpp] : 0};
+        const int b{prior[i]};
+        const int c{(i >= bpp) ? prior[i-bpp] : 0};
+        int predictor{a};
+        if (filter == AVERAGE)
+            predictor = (a + b) / 2;
+        else
+        if (filter == PAETH)
+        {
+            const int pa{std::abs(b - c)};
+            const int pb{std::abs(a - c)};
+            const int pc{std::abs(a + b - c - c)};
+            predictor = ((pa <= pb) && (pa <= pc)) ? a : (pb <= pc) ? b : c;
+        }
+        row[i] = uint8_t(row[i] + predictor);
+    }
+
+    return true;
+}
+
+/**
+ * Convert a row of 8 bit RGBA to premultiplied RGBA.
+ *
+ * @param  row - unfiltered row.
+ * @param  width - number of pixels in the row.
+ * @param  output - set to the premultiplied pixels.
+ */
+static void premultiplyRow(const uint8_t * row, int width, uint8_t * output)
+{
+    int x{};
+#if defined(__SSE2__)
+    // Multiply 2 pixels at a time in 16 bit lanes, by an alpha of 255 in
+    // place of the alpha channel itself, then divide by 255 with rounding.
+    const __m128i zero{_mm_setzero_si128()};
+    const __m128i alphaMask{_mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0)};
+    const __m128i rounding{_mm_set1_epi16(128)};
+    for (; x + 4 <= width; x += 4, row += 16, output += 16)
+    {
+        const __m128i pixels{_mm_loadu_si128(reinterpret_cast<const __m128i *>(row))};
+        __m128i halves[2]{ _mm_unpacklo_epi8(pixels, zero), _mm_unpackhi_epi8(pixels, zero) };
+        for (auto & half : halves)
+        {
+            __m128i alpha{_mm_shufflehi_epi16(_mm_shufflelo_epi16(half, 0xFF), 0xFF)};
+            alpha = _mm_or_si128(_mm_andnot_si128(alphaMask, alpha), _mm_and_si128(alphaMask, _mm_set1_epi16(255)));
+            __m128i v{_mm_add_epi16(_mm_mullo_epi16(half, alpha), rounding)};
+            half = _mm_srli_epi16(_mm_add_epi16(v, _mm_srli_epi16(v, 8)), 8);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output), _mm_packus_epi16(halves[0], halves[1]));
+    }
+#endif
+    for (; x < width; ++x, row += 4, output += 4)
+    {
+        const uint32_t alpha{row[3]};
+        for (int j{}; j < 3; ++j)
+            output[j] = uint8_t(div255(row[j] * alpha));
+        output[3] = row[3];
+    }
+}
+
+/**
+ * Convert a row of image data of any colour type and depth to premultiplied
+ * RGBA.
+ *
+ * @param  format - layout of the image data.
+ * @param  row - unfiltered row.
+ * @param  output - set to the premultiplied pixels.
+ */
+static void convertRow(const Format & format, const uint8_t * row, uint8_t * output)
+{
+    const int width{format.width};
+    const int depth{format.depth};
+    const size_t channels{format.channels};
+
+    if ((format.colourType == 6) && (depth == 8))
+    {
+        premultiplyRow(row, width, output);
+
+        return;
+    }
+
+    if ((format.colourType == 2) && (depth == 8))
+    {
+        for (int x{}; x < width; ++x, row += 3, output += 4)
+        {
+            const bool keyed{(row[0] == format.key[0]) && (row[1] == format.key[1]) && (row[2] == format.key[2])};
+            for (int j{}; j < 3; ++j)
+                output[j] = keyed ? 0 : row[j];
+            output[3] = keyed ? 0 : 255;
+        }
+
+        return;
+    }
+
+    for (int x{}; x < width; ++x, output += 4)
+    {
+        const size_t first{size_t(x) * channels};
+        switch (format.colourType)
+        {
+        case 3:
+            std::memcpy(output, format.palette[getSample(row, first, depth)].data(), 4);
+            break;
+
+        case 0:
+        case 4:
+        {
+            const int grey{getSample(row, first, depth)};
+            const uint32_t alpha{(format.colourType == 4) ? scaleSample(getSample(row, first + 1, depth), depth) : (grey == format.key[0]) ? 0U : 255U};
+            const uint8_t value{uint8_t(div255(scaleSample(grey, depth) * alpha))};
+            output[0] = output[1] = output[2] = value;
+            output[3] = uint8_t(alpha);
+            break;
+        }
+
+        default:
+        {
+            int samples[4]{ 0, 0, 0, (1 << depth) - 1 };
+            for (size_t j{}; j < channels; ++j)
+                samples[j] = getSample(row, first + j, depth);
+
+            const bool keyed{(format.colourType == 2) && (samples[0] == format.key[0]) && (samples[1] == format.key[1]) && (samples[2] == format.key[2])};
+            const uint32_t alpha{keyed ? 0U : scaleSample(samples[3], depth)};
+            for (int j{}; j < 3; ++j)
+                output[j] = uint8_t(div255(scaleSample(samples[j], depth) * alpha));
+            output[3] = uint8_t(alpha);
+            break;
+        }
+        }
+    }
+}
+
+/**
+ * Check that the header describes an image that can be decoded here.
+ *
+ * @param  header - contents of the IHDR chunk.
+ * @param  format - set to the layout of the image data.
+ * @return true if the image is supported, false otherwise.
+ */
+static bool readHeader(const uint8_t * header, Format & format)
+{
+    format.width = int(getInt(header));
+    format.height = int(getInt(header + 4));
+    format.depth = header[8];
+    format.colourType = header[9];
+    const int compression{header[10]};
+    const int filter{header[11]};
+    const int interlace{header[12]};
+
+    switch (format.colourType)
+    {
+    case 0: format.channels = 1; break;
+    case 2: format.channels = 3; break;
+    case 3: format.channels = 1; break;
+    case 4: format.channels = 2; break;
+    case 6: format.channels = 4; break;
+    default: return false;
+    }
+
+    const bool validDepth{(format.colourType == 0) ? ((format.depth == 1) || (format.depth == 2) || (format.depth == 4) || (format.depth == 8) || (format.depth == 16)) :
+                          (format.colourType == 3) ? ((format.depth == 1) || (format.depth == 2) || (format.depth == 4) || (format.depth == 8)) :
+                          ((format.depth == 8) || (format.depth == 16))};
+
+    return (validDepth) && (compression == 0) && (filter == 0) && (interlace == 0) &&
+        (format.width > 0) && (format.height > 0) && (format.width <= (1 << 24)) && (format.height <= (1 << 24));
+}
+
+
+/**
+ * @section PngReader class method code.
+ *
+ */
+
+/**
+ * Decode a .png file to premultiplied RGBA. The image data is inflated
+ * directly from the mapping of the file, a row at a time, so the compressed
+ * and filtered image is never copied. Files that are interlaced, that use
+ * an unknown critical chunk, or whose gAMA chunk doesn't describe sRGB are
+ * rejected so the caller can use libpng instead.
+ *
+ * @param  fileName - name of image file.
+ * @param  width - set to the width of the image.
+ * @param  height - set to the height of the image.
+ * @param  pixels - set to the premultiplied pixels.
+ * @return true if decoded, false otherwise.
+ */
+bool PngReader::read(const std::string & fileName, int & width, int & height, std::vector<uint8_t> & pixels)
+{
+    const Mapping file{fileName};
+    const uint8_t * data{file.getData()};
+    const size_t size{file.getSize()};
+    if ((!data) || (size < 33) || (std::memcmp(data, signature, sizeof(signature))) ||
+        (getInt(data + 8) != 13) || (std::memcmp(data + 12, "IHDR", 4)))
+        return false;
+
+    Format format{};
+    if (!readHeader(data + 16, format))
+        return false;
+
+    format.key[0] = format.key[1] = format.key[2] = -1;
+    for (auto & entry : format.palette)
+        entry = { 0, 0, 0, 255 };
+
+    const size_t rowSize{((size_t(format.width) * format.channels * format.depth) + 7) / 8};
+    const size_t bpp{std::max<size_t>(1, (format.channels * format.depth) / 8)};
+    // Each row starts with its filter type and ends with a byte of padding.
+    const size_t stride{rowSize + 1};
+    // Deflate can't expand data by more than 1032 times, so reject a header
+    // that couldn't describe the file before allocating for it.
+    if ((stride * format.height) / 1032 > size)
+        return false;
+
+    std::vector<uint8_t> row(stride + 1);
+    std::vector<uint8_t> prior(stride + 1, 0);
+    std::vector<uint8_t> output(size_t(format.width) * format.height * 4);
+
+    z_stream stream{};
+    if (inflateInit(&stream) != Z_OK)
+        return false;
+
+    int y{};
+    size_t filled{};
+    bool ok{true};
+    bool ended{};
+    bool premultiplied{};
+    for (size_t pos{33}; (ok) && (!ended) && (pos + 12 <= size); )
+    {
+        const size_t length{getInt(data + pos)};
+        const uint8_t * type{data + pos + 4};
+        const uint8_t * body{data + pos + 8};
+        if ((length > size) || (pos + 12 + length > size))
+        {
+            ok = false;
+            break;
+        }
+
+        if (!std::memcmp(type, "IDAT", 4))
+        {
+            // The palette and its transparency precede the image data.
+            if ((format.colourType == 3) && (!premultiplied))
+                for (auto & entry : format.palette)
+                    for (int j{}; j < 3; ++j)
+                        entry[j] = uint8_t(div255(entry[j] * entry[3]));
+            premultiplied = true;
+
+            stream.next_in = const_cast<Bytef *>(body);
+            stream.avail_in = uInt(length);
+            while ((ok) && (stream.avail_in > 0) && (y < format.height))
+            {
+                stream.next_out = row.data() + filled;
+                stream.avail_out = uInt(stride - filled);
+                const int result{inflate(&stream, Z_NO_FLUSH)};
+                if ((result != Z_OK) && (result != Z_STREAM_END))
+                    ok = false;
+
+                filled = stride - stream.avail_out;
+                if (filled == stride)
+                {
+                    ok = ok && unfilterRow(row[0], row.data() + 1, prior.data() + 1, rowSize, bpp);
+                    if (ok)
+                        convertRow(format, row.data() + 1, output.data() + (size_t(y) * format.width * 4));
+                    std::swap(row, prior);
+                    filled = 0;
+                    ++y;
+                }
+
+                if (result == Z_STREAM_END)
+                    break;
+            }
+        }
+        else
+        if (!std::memcmp(type, "PLTE", 4))
+        {
+            for (size_t i{}; (i < 256) && ((i * 3) + 2 < length); ++i)
+                format.palette[i] = { body[i*3], body[(i*3)+1], body[(i*3)+2], 255 };
+        }
+        else
+        if (!std::memcmp(type, "tRNS", 4))
+        {
+            if (format.colourType == 3)
+                for (size_t i{}; (i < 256) && (i < length); ++i)
+                    format.palette[i][3] = body[i];
+            else
+            if ((format.colourType == 0) && (length >= 2))
+                format.key[0] = (body[0] << 8) | body[1];
+            else
+            if ((format.colourType == 2) && (length >= 6))
+                for (int j{}; j < 3; ++j)
+                    format.key[j] = (body[j*2] << 8) | body[(j*2)+1];
+        }
+        else
+        if (!std::memcmp(type, "gAMA", 4))
+        {
+            // libpng corrects other gammas to sRGB, so leave those to it.
+            const uint32_t gamma{(length >= 4) ? getInt(body) : 0};
+            if ((gamma < 45000) || (gamma > 46000))
+                ok = false;
+        }
+        else
+        if (!std::memcmp(type, "IEND", 4))
+            ended = true;
+        else
+        if (!(type[0] & 0x20))
+            ok = false;
+
+        pos += 12 + length;
+    }
+    inflateEnd(&stream);
+
+    if ((!ok) || (y < format.height))
+        return false;
+
+    width = format.width;
+    height = format.height;
+    pixels = std::move(output);
+
+    return true;
+}
+
+/**
+ * Check that a .png file is complete, which it is if it starts with the
+ * signature and ends with an IEND chunk. This is much quicker than decoding
+ * the file and enough to find a file cut short by a crash.
+ *
+ * @param  fileName - name of image file.
+ * @return true if the file is complete, false otherwise.
+ */
+bool PngReader::isComplete(const std::string & fileName)
+{
+    static const uint8_t end[12]{ 0, 0, 0, 0, 'I', 'E', 'N', 'D', 0xAE, 0x42, 0x60, 0x82 };
+
+    const Mapping file{fileName};
+    const uint8_t * data{file.getData()};
+    const size_t size{file.getSize()};
+
+    return (data) && (size >= sizeof(signature) + sizeof(end)) &&
+        (!std::memcmp(data, signature, sizeof(signature))) && (!std::memcmp(data + size - sizeof(end), end, sizeof(end)));
+}
+
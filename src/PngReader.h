@@ -0,0 +1,52 @@
+/**
+ * @file    PngReader.h
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'cardgen' is a playing card image generator.
+ *
+ * Interface for the PngReader class, the decoder for the component images.
+ */
+
+#if !defined _PNGREADER_H_INCLUDED_
+#define _PNGREADER_H_INCLUDED_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+/**
+ * @section PngReader class.
+ *
+ * Used to decode a .png file straight from a memory mapping of the file,
+ * inflating the image data a row at a time and converting each row to
+ * premultiplied RGBA as soon as it is unfiltered. Interlaced images and
+ * files using chunks it doesn't know are left to libpng.
+ */
+class PngReader
+{
+public:
+    static bool read(const std::string & fileName, int & width, int & height, std::vector<uint8_t> & pixels);
+    static bool isComplete(const std::string & fileName);
+
+};
+
+
+#endif //!defined _PNGREADER_H_INCLUDED_
+
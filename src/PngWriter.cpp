@@ -0,0 +1,550 @@
+/**
+ * @file    PngWriter.cpp
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'cardgen' is a playing card image generator.
+ *
+ * Implementation for the PngWriter class.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+
+#include <zlib.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "PngWriter.h"
+
+
+/**
+ * @section Internal constants and variables.
+ *
+ */
+
+static const uint8_t signature[8]{ 137, 'P', 'N', 'G', '\r', '\n', 26, '\n' };
+static const size_t chunkSize{1 << 16};
+
+enum Filter { NONE, SUB, UP, AVERAGE, PAETH, FILTERS };
+
+/**
+ * The layout of the image data being written.
+ */
+struct Format
+{
+    int width;
+    int height;
+    int depth;
+    int colourType;
+    size_t channels;
+};
+
+
+/**
+ * @section Internal support code.
+ *
+ */
+
+/**
+ * Store a value as 4 big-endian bytes.
+ *
+ * @param  output - bytes to append to.
+ * @param  value - value to store.
+ */
+static void putInt(std::vector<uint8_t> & output, uint32_t value)
+{
+    for (int shift{24}; shift >= 0; shift -= 8)
+        output.push_back(uint8_t(value >> shift));
+}
+
+#if defined(__SSE2__)
+static inline __m128i load(const uint8_t * p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+static inline void store(uint8_t * p, __m128i value) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), value); }
+#endif
+
+/**
+ * Write a chunk to the file, with its length and checksum.
+ *
+ * @param  file - file to write to.
+ * @param  type - 4 character chunk type.
+ * @param  data - contents of the chunk.
+ * @param  size - size of the contents.
+ * @param  bytes - incremented by the number of bytes written.
+ */
+static void writeChunk(std::ofstream & file, const char * type, const uint8_t * data, size_t size, size_t & bytes)
+{
+    std::vector<uint8_t> header{};
+    putInt(header, uint32_t(size));
+    header.insert(header.end(), type, type + 4);
+
+    uLong crc{crc32(0, reinterpret_cast<const Bytef *>(type), 4)};
+    if (size)
+        crc = crc32(crc, data, uInt(size));
+
+    std::vector<uint8_t> trailer{};
+    putInt(trailer, uint32_t(crc));
+
+    file.write(reinterpret_cast<const char *>(header.data()), header.size());
+    file.write(reinterpret_cast<const char *>(data), size);
+    file.write(reinterpret_cast<const char *>(trailer.data()), trailer.size());
+    bytes += header.size() + size + trailer.size();
+}
+
+/**
+ * Apply a filter to a row of the image data.
+ *
+ * @param  filter - filter to apply.
+ * @param  row - unfiltered row.
+ * @param  prior - unfiltered previous row, all zeros for the first row.
+ * @param  size - number of bytes in a row.
+ * @param  bpp - number of bytes per pixel, rounded up to 1.
+ * @param  output - set to the filter type followed by the filtered row.
+ */
+static void filterRow(int filter, const uint8_t * row, const uint8_t * prior, size_t size, size_t bpp, uint8_t * output)
+{
+    // The first pixel has no pixel to its left, so it is handled separately
+    // from the vector loops.
+    *output++ = uint8_t(filter);
+    const size_t first{std::min(bpp, size)};
+    size_t i{first};
+    switch (filter)
+    {
+    case SUB:
+        std::copy(row, row + first, output);
+#if defined(__SSE2__)
+        for (; i + 16 <= size; i += 16)
+            store(output + i, _mm_sub_epi8(load(row + i), load(row + i - bpp)));
+#elif defined(__ARM_NEON)
+        for (; i + 16 <= size; i += 16)
+            vst1q_u8(output + i, vsubq_u8(vld1q_u8(row + i), vld1q_u8(row + i - bpp)));
+#endif
+        for (; i < size; ++i)
+            output[i] = uint8_t(row[i] - row[i-bpp]);
+        break;
+
+    case UP:
+        i = 0;
+#if defined(__SSE2__)
+        for (; i + 16 <= size; i += 16)
+            store(output + i, _mm_sub_epi8(load(row + i), load(prior + i)));
+#elif defined(__ARM_NEON)
+        for (; i + 16 <= size; i += 16)
+            vst1q_u8(output + i, vsubq_u8(vld1q_u8(row + i), vld1q_u8(prior + i)));
+#endif
+        for (; i < size; ++i)
+            output[i] = uint8_t(row[i] - prior[i]);
+        break;
+
+    case AVERAGE:
+        for (size_t j{}; j < first; ++j)
+            output[j] = uint8_t(row[j] - (prior[j] / 2));
+#if defined(__SSE2__)
+        for (; i + 16 <= size; i += 16)
+        {
+            // The rounding of _mm_avg_epu8 is undone by the low bit.
+            const __m128i left{load(row + i - bpp)};
+            const __m128i up{load(prior + i)};
+            const __m128i average{_mm_sub_epi8(_mm_avg_epu8(left, up), _mm_and_si128(_mm_xor_si128(left, up), _mm_set1_epi8(1)))};
+            store(output + i, _mm_sub_epi8(load(row + i), average));
+        }
+#elif defined(__ARM_NEON)
+        for (; i + 16 <= size; i += 16)
+            vst1q_u8(output + i, vsubq_u8(vld1q_u8(row + i), vhaddq_u8(vld1q_u8(row + i - bpp), vld1q_u8(prior + i))));
+#endif
+        for (; i < size; ++i)
+            output[i] = uint8_t(row[i] - ((row[i-bpp] + prior[i]) / 2));
+        break;
+
+    case PAETH:
+    {
+        for (size_t j{}; j < first; ++j)
+            output[j] = uint8_t(row[j] - prior[j]);
+#if defined(__SSE2__)
+        const __m128i zero{_mm_setzero_si128()};
+        for (; i + 8 <= size; i += 8)
+        {
+            const __m128i a{_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(row + i - bpp)), zero)};
+            const __m128i b{_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(prior + i)), zero)};
+            const __m128i c{_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(prior + i - bpp)), zero)};
+            const __m128i bc{_mm_sub_epi16(b, c)};
+            const __m128i ac{_mm_sub_epi16(a, c)};
+            const __m128i abc{_mm_add_epi16(bc, ac)};
+            const __m128i pa{_mm_max_epi16(bc, _mm_sub_epi16(zero, bc))};
+            const __m128i pb{_mm_max_epi16(ac, _mm_sub_epi16(zero, ac))};
+            const __m128i pc{_mm_max_epi16(abc, _mm_sub_epi16(zero, abc))};
+            const __m128i notA{_mm_or_si128(_mm_cmpgt_epi16(pa, pb), _mm_cmpgt_epi16(pa, pc))};
+            const __m128i useC{_mm_cmpgt_epi16(pb, pc)};
+            const __m128i notAValue{_mm_or_si128(_mm_and_si128(useC, c), _mm_andnot_si128(useC, b))};
+            const __m128i predictor{_mm_or_si128(_mm_and_si128(notA, notAValue), _mm_andnot_si128(notA, a))};
+            const __m128i current{_mm_loadl_epi64(reinterpret_cast<const __m128i *>(row + i))};
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(output + i), _mm_sub_epi8(current, _mm_packus_epi16(predictor, zero)));
+        }
+#elif defined(__ARM_NEON)
+        for (; i + 8 <= size; i += 8)
+        {
+            const int16x8_t a{vreinterpretq_s16_u16(vmovl_u8(vld1_u8(row + i - bpp)))};
+            const int16x8_t b{vreinterpretq_s16_u16(vmovl_u8(vld1_u8(prior + i)))};
+            const int16x8_t c{vreinterpretq_s16_u16(vmovl_u8(vld1_u8(prior + i - bpp)))};
+            const int16x8_t bc{vsubq_s16(b, c)};
+            const int16x8_t ac{vsubq_s16(a, c)};
+            const int16x8_t pa{vabsq_s16(bc)};
+            const int16x8_t pb{vabsq_s16(ac)};
+            const int16x8_t pc{vabsq_s16(vaddq_s16(bc, ac))};
+            const uint16x8_t notA{vorrq_u16(vcgtq_s16(pa, pb), vcgtq_s16(pa, pc))};
+            const int16x8_t predictor{vbslq_s16(notA, vbslq_s16(vcgtq_s16(pb, pc), c, b), a)};
+            vst1_u8(output + i, vsub_u8(vld1_u8(row + i), vmovn_u16(vreinterpretq_u16_s16(predictor))));
+        }
+#endif
+        for (; i < size; ++i)
+        {
+            const int a{row[i-bpp]};
+            const int b{prior[i]};
+            const int c{prior[i-bpp]};
+            const int pa{std::abs(b - c)};
+            const int pb{std::abs(a - c)};
+            const int pc{std::abs(a + b - c - c)};
+            const int predictor{((pa <= pb) && (pa <= pc)) ? a : (pb <= pc) ? b : c};
+            output[i] = uint8_t(row[i] - predictor);
+        }
+        break;
+    }
+
+    default:
+        std::copy(row, row + size, output);
+        break;
+    }
+}
+
+/**
+ * Estimate how well a filtered row will compress, as the sum of its bytes
+ * taken as signed values.
+ *
+ * @param  filtered - filter type followed by the filtered row.
+ * @param  size - number of bytes in a row.
+ * @return the estimate, lower being better.
+ */
+static unsigned long getScore(const uint8_t * filtered, size_t size)
+{
+    const uint8_t * bytes{filtered + 1};
+    unsigned long score{};
+    size_t i{};
+#if defined(__SSE2__)
+    // The magnitude of a signed byte is the smaller of it and its negation,
+    // taken as unsigned bytes.
+    const __m128i zero{_mm_setzero_si128()};
+    __m128i sum{zero};
+    for (; i + 16 <= size; i += 16)
+    {
+        const __m128i value{load(bytes + i)};
+        sum = _mm_add_epi64(sum, _mm_sad_epu8(_mm_min_epu8(value, _mm_sub_epi8(zero, value)), zero));
+    }
+    uint64_t lanes[2]{};
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), sum);
+    score = lanes[0] + lanes[1];
+#elif defined(__ARM_NEON)
+    uint32x4_t sum{vdupq_n_u32(0)};
+    for (; i + 16 <= size; i += 16)
+        sum = vpadalq_u16(sum, vpaddlq_u8(vreinterpretq_u8_s8(vabsq_s8(vreinterpretq_s8_u8(vld1q_u8(bytes + i))))));
+    uint32_t lanes[4]{};
+    vst1q_u32(lanes, sum);
+    score = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+    for (; i < size; ++i)
+        score += std::abs(int(int8_t(bytes[i])));
+
+    return score;
+}
+
+/**
+ * Write a .png file, filtering and compressing each row as it is generated.
+ * The file is written under a temporary name and renamed into place, so a
+ * file with the final name is always complete.
+ *
+ * @param  fileName - name of image file.
+ * @param  format - layout of the image data.
+ * @param  chunks - the PLTE and tRNS chunks, if any, as type and contents.
+ * @param  level - speed and size trade-off.
+ * @param  getRow - function to generate the unfiltered bytes of a row.
+ * @param  bytes - set to the size of the file.
+ * @return true if the file was written, false otherwise.
+ */
+static bool encode(const std::string & fileName, const Format & format,
+    const std::vector<std::pair<const char *, std::vector<uint8_t>>> & chunks,
+    PngWriter::Level level, const std::function<void(int, uint8_t *)> & getRow, size_t & bytes)
+{
+    bytes = 0;
+    const std::string tempFile{PngWriter::getTempFilename(fileName)};
+    std::ofstream file{tempFile.c_str(), std::ios::binary};
+    if (!file)
+        return false;
+
+    file.write(reinterpret_cast<const char *>(signature), sizeof(signature));
+    bytes += sizeof(signature);
+
+    std::vector<uint8_t> header{};
+    putInt(header, uint32_t(format.width));
+    putInt(header, uint32_t(format.height));
+    header.insert(header.end(), { uint8_t(format.depth), uint8_t(format.colourType), 0, 0, 0 });
+    writeChunk(file, "IHDR", header.data(), header.size(), bytes);
+
+    for (const auto & [type, data] : chunks)
+        writeChunk(file, type, data.data(), data.size(), bytes);
+
+    // Palette images aren't filtered, as the indices don't predict well.
+    const bool indexed{format.colourType == 3};
+    const bool adaptive{(!indexed) && (level != PngWriter::Level::FAST)};
+    const int compression{(level == PngWriter::Level::FAST) ? 1 : (level == PngWriter::Level::MAX) ? 9 : Z_DEFAULT_COMPRESSION};
+    const int strategy{(level == PngWriter::Level::FAST) ? Z_FIXED : indexed ? Z_DEFAULT_STRATEGY : Z_FILTERED};
+
+    z_stream stream{};
+    if (deflateInit2(&stream, compression, Z_DEFLATED, 15, (level == PngWriter::Level::MAX) ? 9 : 8, strategy) != Z_OK)
+    {
+        file.close();
+        std::remove(tempFile.c_str());
+
+        return false;
+    }
+
+    const size_t size{((size_t(format.width) * format.channels * format.depth) + 7) / 8};
+    const size_t bpp{std::max<size_t>(1, (format.channels * format.depth) / 8)};
+    std::vector<uint8_t> row(size), prior(size, 0);
+    std::vector<uint8_t> filtered((size + 1) * (adaptive ? FILTERS : 1));
+    std::vector<uint8_t> output(chunkSize);
+
+    bool ok{true};
+    for (int y{}; (ok) && (y <= format.height); ++y)
+    {
+        const uint8_t * best{filtered.data()};
+        if (y < format.height)
+        {
+            getRow(y, row.data());
+            if (adaptive)
+            {
+                unsigned long bestScore{};
+                for (int filter{}; filter < FILTERS; ++filter)
+                {
+                    uint8_t * candidate{filtered.data() + (filter * (size + 1))};
+                    filterRow(filter, row.data(), prior.data(), size, bpp, candidate);
+                    const unsigned long score{getScore(candidate, size)};
+                    if ((filter == 0) || (score < bestScore))
+                    {
+                        best = candidate;
+                        bestScore = score;
+                    }
+                }
+            }
+            else
+                filterRow(indexed ? NONE : UP, row.data(), prior.data(), size, bpp, filtered.data());
+            std::swap(row, prior);
+        }
+
+        // Compress the row, or finish the stream after the last row.
+        stream.next_in = const_cast<Bytef *>(best);
+        stream.avail_in = (y < format.height) ? uInt(size + 1) : 0;
+        const int flush{(y < format.height) ? Z_NO_FLUSH : Z_FINISH};
+        int result{};
+        do
+        {
+            stream.next_out = output.data();
+            stream.avail_out = uInt(output.size());
+            result = deflate(&stream, flush);
+            if ((result != Z_OK) && (result != Z_STREAM_END) && (result != Z_BUF_ERROR))
+                ok = false;
+
+            const size_t produced{output.size() - stream.avail_out};
+            if (produced)
+                writeChunk(file, "IDAT", output.data(), produced, bytes);
+        } while ((ok) && (stream.avail_out == 0));
+    }
+    deflateEnd(&stream);
+
+    writeChunk(file, "IEND", nullptr, 0, bytes);
+    file.close();
+
+    if ((!ok) || (!file) || (std::rename(tempFile.c_str(), fileName.c_str())))
+    {
+        std::remove(tempFile.c_str());
+
+        return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * @section PngWriter class method code.
+ *
+ */
+
+/**
+ * Look up an encoding level by name.
+ *
+ * @param  name - name of the level.
+ * @param  level - set to the level if found.
+ * @return true if the level was found, false otherwise.
+ */
+bool PngWriter::parseLevel(const std::string & name, Level & level)
+{
+    if (name == "fast")
+        level = Level::FAST;
+    else
+    if (name == "default")
+        level = Level::DEFAULT;
+    else
+    if (name == "max")
+        level = Level::MAX;
+    else
+        return false;
+
+    return true;
+}
+
+/**
+ * Get the name of an encoding level.
+ *
+ * @param  level - the level.
+ * @return the name of the level.
+ */
+std::string PngWriter::getLevelName(Level level)
+{
+    switch (level)
+    {
+    case Level::FAST:   return "fast";
+    case Level::MAX:    return "max";
+    default:            return "default";
+    }
+}
+
+/**
+ * Get the temporary name a .png file is written under before it is
+ * renamed into place.
+ *
+ * @param  fileName - name of image file.
+ * @return the temporary name.
+ */
+std::string PngWriter::getTempFilename(const std::string & fileName)
+{
+    return fileName + ".tmp";
+}
+
+/**
+ * Write a canvas to a .png file, converting it back to straight alpha. A
+ * canvas with no transparent pixels is written without the alpha channel.
+ *
+ * @param  fileName - name of image file.
+ * @param  canvas - canvas to write.
+ * @param  level - speed and size trade-off.
+ * @param  bytes - set to the size of the file.
+ * @return true if the file was written, false otherwise.
+ */
+bool PngWriter::write(const std::string & fileName, const Canvas & canvas, Level level, size_t & bytes)
+{
+    const int width{canvas.getWidth()};
+    const int height{canvas.getHeight()};
+
+    bool opaque{true};
+    for (int y{}; (opaque) && (y < height); ++y)
+    {
+        const uint8_t * pixel{canvas.getRow(y)};
+        for (int x{}; (opaque) && (x < width); ++x, pixel += 4)
+            opaque = (pixel[3] == 255);
+    }
+
+    const Format format{width, height, 8, opaque ? 2 : 6, opaque ? 3U : 4U};
+
+    return encode(fileName, format, {}, level, [&](int y, uint8_t * row) {
+        const uint8_t * pixel{canvas.getRow(y)};
+        for (int x{}; x < width; ++x, pixel += 4)
+        {
+            const uint32_t alpha{pixel[3]};
+            for (int j{}; j < 3; ++j)
+                *row++ = ((alpha == 0) || (alpha == 255)) ? pixel[j] : uint8_t(std::min(255U, ((pixel[j] * 255U) + (alpha / 2)) / alpha));
+            if (!opaque)
+                *row++ = pixel[3];
+        }
+    }, bytes);
+}
+
+/**
+ * Write a canvas that has been reduced to a palette to a .png file, as
+ * palette indices packed into 1, 2, 4 or 8 bits each.
+ *
+ * @param  fileName - name of image file.
+ * @param  canvas - canvas to write, for its size.
+ * @param  palette - premultiplied colours of the palette.
+ * @param  indices - palette index of each pixel.
+ * @param  level - speed and size trade-off.
+ * @param  bytes - set to the size of the file.
+ * @return true if the file was written, false otherwise.
+ */
+bool PngWriter::write(const std::string & fileName, const Canvas & canvas, const std::vector<Canvas::Pixel> & palette, const std::vector<uint8_t> & indices, Level level, size_t & bytes)
+{
+    const int width{canvas.getWidth()};
+    const int height{canvas.getHeight()};
+    const int depth{(palette.size() <= 2) ? 1 : (palette.size() <= 4) ? 2 : (palette.size() <= 16) ? 4 : 8};
+
+    // The alpha of each entry is only needed up to the last that isn't opaque.
+    std::vector<uint8_t> colours{};
+    std::vector<uint8_t> alphas{};
+    size_t transparent{};
+    for (size_t i{}; i < palette.size(); ++i)
+    {
+        const uint32_t alpha{palette[i][3]};
+        for (int j{}; j < 3; ++j)
+            colours.push_back(((alpha == 0) || (alpha == 255)) ? palette[i][j] : uint8_t(std::min(255U, ((palette[i][j] * 255U) + (alpha / 2)) / alpha)));
+        alphas.push_back(palette[i][3]);
+        if (alpha != 255)
+            transparent = i + 1;
+    }
+    alphas.resize(transparent);
+
+    std::vector<std::pair<const char *, std::vector<uint8_t>>> chunks{ { "PLTE", colours } };
+    if (!alphas.empty())
+        chunks.emplace_back("tRNS", alphas);
+
+    const Format format{width, height, depth, 3, 1};
+
+    return encode(fileName, format, chunks, level, [&](int y, uint8_t * row) {
+        const uint8_t * index{indices.data() + (size_t(y) * width)};
+        if (depth == 8)
+        {
+            std::copy(index, index + width, row);
+
+            return;
+        }
+
+        const int perByte{8 / depth};
+        for (int x{}; x < width; x += perByte)
+        {
+            uint8_t packed{};
+            for (int i{}; i < perByte; ++i)
+                packed = uint8_t((packed << depth) | ((x + i < width) ? index[x + i] : 0));
+            *row++ = packed;
+        }
+    }, bytes);
+}
+
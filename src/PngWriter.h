@@ -0,0 +1,62 @@
+/**
+ * @file    PngWriter.h
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'cardgen' is a playing card image generator.
+ *
+ * Interface for the PngWriter class, the encoder for the rendered cards.
+ */
+
+#if !defined _PNGWRITER_H_INCLUDED_
+#define _PNGWRITER_H_INCLUDED_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Canvas.h"
+
+
+/**
+ * @section PngWriter class.
+ *
+ * Used to encode a canvas as a .png file, trading file size for speed:
+ * "fast" uses a single filter and fixed Huffman codes, "default" chooses
+ * the filter for each row and "max" adds the slowest zlib settings. A
+ * canvas reduced to a palette is written as palette indices, packed into
+ * as few bits as the palette allows.
+ */
+class PngWriter
+{
+public:
+    enum class Level { FAST, DEFAULT, MAX };
+
+    static bool parseLevel(const std::string & name, Level & level);
+    static std::string getLevelName(Level level);
+    static std::string getTempFilename(const std::string & fileName);
+
+    static bool write(const std::string & fileName, const Canvas & canvas, Level level, size_t & bytes);
+    static bool write(const std::string & fileName, const Canvas & canvas, const std::vector<Canvas::Pixel> & palette, const std::vector<uint8_t> & indices, Level level, size_t & bytes);
+
+};
+
+
+#endif //!defined _PNGWRITER_H_INCLUDED_
+
@@ -0,0 +1,140 @@
+/**
+ * @file    Pool.cpp
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'cardgen' is a playing card image generator.
+ *
+ * Implementation for the Pool class.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <thread>
+
+#include "cardgen.h"
+#include "Pool.h"
+#include "Configuration.h"
+
+
+/**
+ * @section Pool class method code.
+ *
+ */
+
+/**
+ * Take the next task from the front of a thread's own queue.
+ *
+ * @param  queue - queue of the thread.
+ * @param  task - set to the task taken.
+ * @return true if a task was taken, false if the queue is empty.
+ */
+bool Pool::pop(Queue & queue, size_t & task)
+{
+    std::lock_guard<std::mutex> lock{queue.mutex};
+    if (queue.tasks.empty())
+        return false;
+
+    task = queue.tasks.front();
+    queue.tasks.pop_front();
+
+    return true;
+}
+
+/**
+ * Take a task from the back of another thread's queue.
+ *
+ * @param  queue - queue of the other thread.
+ * @param  task - set to the task taken.
+ * @return true if a task was taken, false if the queue is empty.
+ */
+bool Pool::steal(Queue & queue, size_t & task)
+{
+    std::lock_guard<std::mutex> lock{queue.mutex};
+    if (queue.tasks.empty())
+        return false;
+
+    task = queue.tasks.back();
+    queue.tasks.pop_back();
+
+    return true;
+}
+
+/**
+ * Get the number of threads to use, which is the number given with --jobs
+ * or the number of cores.
+ *
+ * @return the number of threads.
+ */
+size_t Pool::getThreadCount(void)
+{
+    if (Config::isJobs())
+        return size_t(Config::getJobs());
+
+    return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+/**
+ * Run a set of tasks on the pool. The tasks are sorted by their estimated
+ * cost and dealt out to the threads in turn, so each thread starts with
+ * the most expensive of its share. No tasks are added once the pool is
+ * running, so a thread finishes when it finds every queue empty.
+ *
+ * @param  costs - estimated cost of each task.
+ * @param  fn - function to call with the index of each task.
+ * @return the sum of the values returned by the function.
+ */
+int Pool::run(const std::vector<long> & costs, const std::function<int(size_t)> & fn)
+{
+    std::vector<size_t> order(costs.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&costs](size_t a, size_t b) { return costs[a] > costs[b]; });
+
+    const size_t count{std::max<size_t>(std::min(getThreadCount(), order.size()), 1)};
+    std::vector<Queue> queues(count);
+    for (size_t i{}; i < order.size(); ++i)
+        queues[i % count].tasks.push_back(order[i]);
+
+    std::atomic<int> total{};
+    auto worker{[&](size_t self) {
+        size_t task{};
+        for (;;)
+        {
+            bool found{pop(queues[self], task)};
+            for (size_t i{1}; (!found) && (i < count); ++i)
+                found = steal(queues[(self + i) % count], task);
+
+            if (!found)
+                break;
+
+            total += fn(task);
+        }
+    }};
+
+    std::vector<std::thread> threads{};
+    for (size_t i{1}; i < count; ++i)
+        threads.emplace_back(worker, i);
+    worker(0);
+
+    for (auto & thread : threads)
+        thread.join();
+
+    return total;
+}
+
@@ -0,0 +1,64 @@
+/**
+ * @file    Pool.h
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'cardgen' is a playing card image generator.
+ *
+ * Interface for the Pool class, a work-stealing pool of threads.
+ */
+
+#if !defined _POOL_H_INCLUDED_
+#define _POOL_H_INCLUDED_
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+
+/**
+ * @section Pool class.
+ *
+ * Used to run a set of independent tasks, such as drawing the cards, on a
+ * thread for each core. The tasks are dealt out most expensive first and a
+ * thread that runs out of tasks steals the cheapest remaining task from
+ * another thread, so no thread is left idle while the others work through
+ * the costly court cards.
+ */
+class Pool
+{
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    static bool pop(Queue & queue, size_t & task);
+    static bool steal(Queue & queue, size_t & task);
+
+public:
+    static size_t getThreadCount(void);
+    static int run(const std::vector<long> & costs, const std::function<int(size_t)> & fn);
+
+};
+
+
+#endif //!defined _POOL_H_INCLUDED_
+
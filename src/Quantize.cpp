@@ -0,0 +1,434 @@
+/**
+ * @file    Quantize.cpp
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'cardgen' is a playing card image generator.
+ *
+ * Implementation for the Quantize class.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "Quantize.h"
+
+
+/**
+ * @section Internal constants and variables.
+ *
+ */
+
+static const int bayer[8][8]{
+    {  0, 32,  8, 40,  2, 34, 10, 42 },
+    { 48, 16, 56, 24, 50, 18, 58, 26 },
+    { 12, 44,  4, 36, 14, 46,  6, 38 },
+    { 60, 28, 52, 20, 62, 30, 54, 22 },
+    {  3, 35, 11, 43,  1, 33,  9, 41 },
+    { 51, 19, 59, 27, 49, 17, 57, 25 },
+    { 15, 47,  7, 39, 13, 45,  5, 37 },
+    { 63, 31, 55, 23, 61, 29, 53, 21 },
+};
+
+static const size_t memoLimit{1 << 18};
+
+/**
+ * A colour of the histogram and the number of pixels using it.
+ */
+struct Colour
+{
+    Canvas::Pixel pixel;
+    uint32_t count;
+};
+
+/**
+ * A box of the median cut, holding the colours from begin up to end, with
+ * the channel over which they are most spread out.
+ */
+struct Box
+{
+    size_t begin;
+    size_t end;
+    uint64_t count;
+    int channel;
+    int range;
+};
+
+
+/**
+ * @section Internal support code.
+ *
+ */
+
+/**
+ * Pack a pixel into a single value, for use as a histogram key.
+ *
+ * @param  pixel - the pixel.
+ * @return the packed value.
+ */
+static uint32_t pack(const uint8_t * pixel)
+{
+    uint32_t value{};
+    std::memcpy(&value, pixel, 4);
+
+    return value;
+}
+
+/**
+ * Find the number of pixels in a box and the channel with the widest range.
+ *
+ * @param  box - box to measure.
+ * @param  colours - colours of the histogram.
+ */
+static void measure(Box & box, const std::vector<Colour> & colours)
+{
+    int low[4]{ 255, 255, 255, 255 };
+    int high[4]{};
+    box.count = 0;
+    for (size_t i{box.begin}; i < box.end; ++i)
+    {
+        for (int j{}; j < 4; ++j)
+        {
+            low[j] = std::min<int>(low[j], colours[i].pixel[j]);
+            high[j] = std::max<int>(high[j], colours[i].pixel[j]);
+        }
+        box.count += colours[i].count;
+    }
+
+    box.channel = 0;
+    box.range = 0;
+    for (int j{}; j < 4; ++j)
+        if (high[j] - low[j] > box.range)
+        {
+            box.channel = j;
+            box.range = high[j] - low[j];
+        }
+}
+
+/**
+ * Used to find the palette entry nearest to a colour. The entries are
+ * sorted on the green channel, so the search can stop as soon as the green
+ * channel alone is further away than the best entry found. Exact colours
+ * are remembered as most cards use relatively few of them.
+ */
+class Nearest
+{
+private:
+    const Quantize::Palette & palette;
+    std::vector<std::pair<int, uint8_t>> order;
+    std::unordered_map<uint32_t, uint8_t> memo;
+
+public:
+    explicit Nearest(const Quantize::Palette & entries) : palette{entries}, order{}, memo{}
+    {
+        for (size_t i{}; i < palette.size(); ++i)
+            order.emplace_back(palette[i][1], uint8_t(i));
+        std::sort(order.begin(), order.end());
+    }
+
+    uint8_t find(const int * colour);
+
+};
+
+/**
+ * Find the palette entry nearest to a colour.
+ *
+ * @param  colour - channels of the colour.
+ * @return the index of the nearest palette entry.
+ */
+uint8_t Nearest::find(const int * colour)
+{
+    const uint32_t key{uint32_t(colour[0]) | (uint32_t(colour[1]) << 8) | (uint32_t(colour[2]) << 16) | (uint32_t(colour[3]) << 24)};
+    const auto it{memo.find(key)};
+    if (it != memo.end())
+        return it->second;
+
+    int best{};
+    int bestDistance{1 << 30};
+    auto distance = [&](size_t i) {
+        const auto & entry{palette[order[i].second]};
+        int sum{};
+        for (int j{}; j < 4; ++j)
+            sum += (colour[j] - entry[j]) * (colour[j] - entry[j]);
+
+        if (sum < bestDistance)
+        {
+            bestDistance = sum;
+            best = order[i].second;
+        }
+    };
+
+    const size_t start{size_t(std::lower_bound(order.begin(), order.end(), std::make_pair(colour[1], uint8_t{})) - order.begin())};
+    for (size_t i{start}; i < order.size(); ++i)
+    {
+        const int d{order[i].first - colour[1]};
+        if (d * d >= bestDistance)
+            break;
+        distance(i);
+    }
+    for (size_t i{start}; i-- > 0; )
+    {
+        const int d{colour[1] - order[i].first};
+        if (d * d >= bestDistance)
+            break;
+        distance(i);
+    }
+
+    if (memo.size() >= memoLimit)
+        memo.clear();
+    memo[key] = uint8_t(best);
+
+    return uint8_t(best);
+}
+
+
+/**
+ * @section Quantize class method code.
+ *
+ */
+
+/**
+ * Look up a dither method by name.
+ *
+ * @param  name - name of the dither method.
+ * @param  dither - set to the dither method if found.
+ * @return true if the dither method was found, false otherwise.
+ */
+bool Quantize::parseDither(const std::string & name, Dither & dither)
+{
+    if (name == "none")
+        dither = Dither::NONE;
+    else
+    if (name == "ordered")
+        dither = Dither::ORDERED;
+    else
+    if (name == "diffusion")
+        dither = Dither::DIFFUSION;
+    else
+        return false;
+
+    return true;
+}
+
+/**
+ * Get the name of a dither method.
+ *
+ * @param  dither - the dither method.
+ * @return the name of the dither method.
+ */
+std::string Quantize::getDitherName(Dither dither)
+{
+    switch (dither)
+    {
+    case Dither::ORDERED:   return "ordered";
+    case Dither::DIFFUSION: return "diffusion";
+    default:                return "none";
+    }
+}
+
+/**
+ * Add the colours of a canvas to a histogram. Cards are mostly made up of
+ * runs of the same colour, so each run is counted in one go.
+ *
+ * @param  histogram - histogram to add to.
+ * @param  canvas - canvas to count the colours of.
+ */
+void Quantize::addHistogram(Histogram & histogram, const Canvas & canvas)
+{
+    if (canvas.isEmpty())
+        return;
+
+    const uint8_t * pixel{canvas.getRow(0)};
+    const size_t size{size_t(canvas.getWidth()) * canvas.getHeight()};
+    for (size_t i{}; i < size; )
+    {
+        const uint32_t value{pack(pixel + (i * 4))};
+        size_t j{i + 1};
+        while ((j < size) && (pack(pixel + (j * 4)) == value))
+            ++j;
+
+        histogram[value] += uint32_t(j - i);
+        i = j;
+    }
+}
+
+/**
+ * Add the colours of one histogram to another.
+ *
+ * @param  histogram - histogram to add to.
+ * @param  other - histogram to add.
+ */
+void Quantize::addHistogram(Histogram & histogram, const Histogram & other)
+{
+    for (const auto & [value, count] : other)
+        histogram[value] += count;
+}
+
+/**
+ * Choose a palette for the colours of a histogram by median cut. The box
+ * with the most pixels spread over the widest range is repeatedly split at
+ * the median pixel of its widest channel, and each palette entry is the
+ * mean of the colours in a box. A histogram that already has few enough
+ * colours is used as it is.
+ *
+ * @param  histogram - colours to choose a palette for.
+ * @param  colours - maximum number of palette entries.
+ * @return the palette.
+ */
+Quantize::Palette Quantize::genPalette(const Histogram & histogram, int colours)
+{
+    // Sort the colours so that the palette doesn't depend on the order the
+    // histogram was built in.
+    std::vector<std::pair<uint32_t, uint32_t>> sorted{histogram.begin(), histogram.end()};
+    std::sort(sorted.begin(), sorted.end());
+
+    std::vector<Colour> list{};
+    list.reserve(sorted.size());
+    for (const auto & [value, count] : sorted)
+    {
+        Colour colour{{}, count};
+        std::memcpy(colour.pixel.data(), &value, 4);
+        list.push_back(colour);
+    }
+
+    Palette palette{};
+    if (list.size() <= size_t(colours))
+    {
+        for (const auto & colour : list)
+            palette.push_back(colour.pixel);
+
+        return palette;
+    }
+
+    std::vector<Box> boxes{ { 0, list.size(), 0, 0, 0 } };
+    measure(boxes.front(), list);
+    while (boxes.size() < size_t(colours))
+    {
+        auto it{std::max_element(boxes.begin(), boxes.end(), [](const Box & a, const Box & b) {
+            return (a.count * a.range) < (b.count * b.range);
+        })};
+        if (it->range == 0)
+            break;
+
+        const Box box{*it};
+        const int channel{box.channel};
+        std::sort(list.begin() + box.begin, list.begin() + box.end, [channel](const Colour & a, const Colour & b) {
+            return a.pixel[channel] < b.pixel[channel];
+        });
+
+        uint64_t below{};
+        size_t split{box.begin};
+        while ((split + 1 < box.end) && (below * 2 < box.count))
+            below += list[split++].count;
+
+        Box low{box.begin, split, 0, 0, 0};
+        Box high{split, box.end, 0, 0, 0};
+        measure(low, list);
+        measure(high, list);
+        *it = low;
+        boxes.push_back(high);
+    }
+
+    for (const auto & box : boxes)
+    {
+        uint64_t sum[4]{};
+        for (size_t i{box.begin}; i < box.end; ++i)
+            for (int j{}; j < 4; ++j)
+                sum[j] += uint64_t(list[i].pixel[j]) * list[i].count;
+
+        Canvas::Pixel entry{};
+        for (int j{}; j < 4; ++j)
+            entry[j] = uint8_t((sum[j] + (box.count / 2)) / box.count);
+
+        // Keep the colour channels valid for premultiplied alpha.
+        for (int j{}; j < 3; ++j)
+            entry[j] = std::min(entry[j], entry[3]);
+
+        palette.push_back(entry);
+    }
+
+    return palette;
+}
+
+/**
+ * Map each pixel of a canvas to the nearest palette entry. Ordered
+ * dithering adds a fixed 8x8 pattern to the colour channels first, while
+ * error diffusion spreads the difference between each pixel and its palette
+ * entry over the pixels yet to be mapped (Floyd-Steinberg). The alpha
+ * channel isn't dithered, so the edges of the card stay clean.
+ *
+ * @param  canvas - canvas to map.
+ * @param  palette - palette to map to.
+ * @param  dither - dither method.
+ * @param  indices - set to the palette index of each pixel.
+ */
+void Quantize::map(const Canvas & canvas, const Palette & palette, Dither dither, std::vector<uint8_t> & indices)
+{
+    const int width{canvas.getWidth()};
+    const int height{canvas.getHeight()};
+    indices.resize(size_t(width) * height);
+    if (palette.empty())
+        return;
+
+    Nearest nearest{palette};
+    const float spread{256.0F / std::cbrt(float(palette.size()))};
+
+    // Two rows of errors for the colour channels, with a pixel of padding
+    // at each end so the edges need no special handling.
+    const size_t stride{(size_t(width) + 2) * 3};
+    std::vector<float> errors((dither == Dither::DIFFUSION) ? stride * 2 : 0);
+
+    for (int y{}; y < height; ++y)
+    {
+        const uint8_t * pixel{canvas.getRow(y)};
+        uint8_t * index{indices.data() + (size_t(y) * width)};
+        float * current{errors.empty() ? nullptr : errors.data() + ((y % 2) * stride) + 3};
+        float * next{errors.empty() ? nullptr : errors.data() + (((y + 1) % 2) * stride) + 3};
+        if (next)
+            std::fill(next - 3, next - 3 + stride, 0.0F);
+
+        for (int x{}; x < width; ++x, pixel += 4)
+        {
+            int colour[4]{ pixel[0], pixel[1], pixel[2], pixel[3] };
+            if (dither == Dither::ORDERED)
+            {
+                const float offset{(((bayer[y % 8][x % 8] + 0.5F) / 64) - 0.5F) * spread};
+                for (int j{}; j < 3; ++j)
+                    colour[j] = std::clamp(int(std::lround(colour[j] + offset)), 0, colour[3]);
+            }
+            else
+            if (dither == Dither::DIFFUSION)
+                for (int j{}; j < 3; ++j)
+                    colour[j] = std::clamp(int(std::lround(colour[j] + current[(x * 3) + j])), 0, colour[3]);
+
+            index[x] = nearest.find(colour);
+
+            if (dither == Dither::DIFFUSION)
+                for (int j{}; j < 3; ++j)
+                {
+                    const float error{float(colour[j] - palette[index[x]][j])};
+                    current[((x + 1) * 3) + j] += error * (7.0F / 16);
+                    next[((x - 1) * 3) + j] += error * (3.0F / 16);
+                    next[(x * 3) + j] += error * (5.0F / 16);
+                    next[((x + 1) * 3) + j] += error * (1.0F / 16);
+                }
+        }
+    }
+}
+
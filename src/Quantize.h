@@ -0,0 +1,66 @@
+/**
+ * @file    Quantize.h
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'cardgen' is a playing card image generator.
+ *
+ * Interface for the Quantize class, used to reduce the colours of a card.
+ */
+
+#if !defined _QUANTIZE_H_INCLUDED_
+#define _QUANTIZE_H_INCLUDED_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Canvas.h"
+
+
+/**
+ * @section Quantize class.
+ *
+ * Used to reduce a card to a palette of at most 256 colours, as the
+ * '+dither -colors 256' of the generated script does. The palette is chosen
+ * by median cut over a histogram of the colours used, which can be built
+ * from a single card or from every card of a deck so that they all share
+ * the same palette. All colours are premultiplied RGBA, as on the Canvas.
+ */
+class Quantize
+{
+public:
+    enum class Dither { NONE, ORDERED, DIFFUSION };
+
+    using Histogram = std::unordered_map<uint32_t, uint32_t>;
+    using Palette = std::vector<Canvas::Pixel>;
+
+    static bool parseDither(const std::string & name, Dither & dither);
+    static std::string getDitherName(Dither dither);
+
+    static void addHistogram(Histogram & histogram, const Canvas & canvas);
+    static void addHistogram(Histogram & histogram, const Histogram & other);
+    static Palette genPalette(const Histogram & histogram, int colours);
+    static void map(const Canvas & canvas, const Palette & palette, Dither dither, std::vector<uint8_t> & indices);
+
+};
+
+
+#endif //!defined _QUANTIZE_H_INCLUDED_
+
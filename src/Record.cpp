@@ -0,0 +1,238 @@
+/**
+ * @file    Record.cpp
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'cardgen' is a playing card image generator.
+ *
+ * Implementation for the Record class.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "cardgen.h"
+#include "Record.h"
+#include "PngReader.h"
+#include "PngWriter.h"
+#include "Shard.h"
+#include "Configuration.h"
+
+
+/**
+ * @section Internal constants and variables.
+ *
+ */
+
+static const std::string header{"# cardgen record: the key of each card and its name."};
+static const std::string forgotten{"-"};
+
+std::atomic<int> Record::unchanged{};
+
+
+/**
+ * @section Record class method code.
+ *
+ */
+
+/**
+ * Constructor. Read the record of an output directory, if it has one.
+ *
+ * @param  outputDirectory - output directory of the deck.
+ */
+Record::Record(const std::string & outputDirectory) : fileName{outputDirectory + _recordFilename}, keys{}, fd{-1}, modified{}, mutex{}
+{
+    std::ifstream file{fileName.c_str()};
+    std::string line{};
+    while (std::getline(file, line))
+    {
+        if ((line.empty()) || (line[0] == '#'))
+            continue;
+
+        std::istringstream stream{line};
+        std::string key{};
+        std::string name{};
+        if (!(stream >> key >> name))
+            continue;
+
+        if (key == forgotten)
+            keys.erase(name);
+        else
+            keys[name] = key;
+    }
+}
+
+/**
+ * Destructor. Close the journal.
+ */
+Record::~Record(void)
+{
+    if (fd >= 0)
+        close(fd);
+}
+
+/**
+ * Append a line to the journal, opening it on first use. Each line is
+ * written with a single call, so lines are never interleaved. A line that
+ * can't be written is only lost if the run is interrupted, as save()
+ * rewrites the whole journal.
+ *
+ * @param  key - key of the card, or "-" if it has been forgotten.
+ * @param  name - name of the card.
+ */
+void Record::append(const std::string & key, const std::string & name)
+{
+    modified = true;
+    if (fd < 0)
+        fd = open(fileName.c_str(), O_WRONLY|O_APPEND|O_CREAT|O_CLOEXEC, 0644);
+
+    const std::string line{key + " " + name + "\n"};
+    if ((fd < 0) || (write(fd, line.data(), line.size()) != ssize_t(line.size())))
+        std::cerr << "Can't append to record " << fileName << "\n";
+}
+
+/**
+ * Check if the cards that are unchanged since they were last drawn are to
+ * be skipped, as they are with --incremental or --resume.
+ *
+ * @return true if skipped, false otherwise.
+ */
+bool Record::isIncremental(void)
+{
+    return (Config::isIncremental()) || (Config::isResume());
+}
+
+/**
+ * Check if a card is unchanged since it was last drawn, which requires its
+ * key to match the record and its output file to still exist. With
+ * --resume the output file must also be a complete .png file, and any
+ * partial file left by an interrupted write is removed.
+ *
+ * @param  name - name of the card.
+ * @param  key - key of the card.
+ * @param  outputFile - output file of the card.
+ * @return true if the card is unchanged, false otherwise.
+ */
+bool Record::check(const std::string & name, const std::string & key, const std::string & outputFile)
+{
+    std::error_code ec{};
+    if (Config::isResume())
+        std::filesystem::remove(PngWriter::getTempFilename(outputFile), ec);
+
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        auto it{keys.find(name)};
+        if ((it == keys.end()) || (it->second != key))
+            return false;
+    }
+
+    if (!std::filesystem::exists(outputFile, ec))
+        return false;
+
+    if ((Config::isResume()) && (!PngReader::isComplete(outputFile)))
+        return false;
+
+    ++unchanged;
+
+    return true;
+}
+
+/**
+ * Record the key of a card once its .png file is in place.
+ *
+ * @param  name - name of the card.
+ * @param  key - key of the card.
+ */
+void Record::update(const std::string & name, const std::string & key)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    auto & current{keys[name]};
+    if (current != key)
+    {
+        current = key;
+        append(key, name);
+    }
+}
+
+/**
+ * Forget a card, so that it is drawn again by the next run.
+ *
+ * @param  name - name of the card.
+ */
+void Record::erase(const std::string & name)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    if (keys.erase(name))
+        append(forgotten, name);
+}
+
+/**
+ * Rewrite the journal with only the last line for each card, if anything
+ * has been appended. It is written to a temporary file and renamed into
+ * place so that an interrupted run never leaves a partial record. The
+ * shards of a run may share an output directory and append to the same
+ * journal, so a sharded run leaves it for the next unsharded run to
+ * rewrite, rather than lose the lines of the other shards.
+ *
+ * @return error value or 0 if no errors.
+ */
+int Record::save(void)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    if (fd >= 0)
+    {
+        close(fd);
+        fd = -1;
+    }
+
+    if ((!modified) || (Shard::isEnabled()))
+        return 0;
+
+    const std::string tempFile{fileName + ".tmp"};
+    {
+        std::ofstream file{tempFile.c_str()};
+        file << header << "\n";
+        for (const auto & [name, key] : keys)
+            file << key << " " << name << "\n";
+
+        if (!file)
+        {
+            std::cerr << "Can't write record " << tempFile << "\n";
+
+            return 1;
+        }
+    }
+
+    std::error_code ec{};
+    std::filesystem::rename(tempFile, fileName, ec);
+    if (ec)
+    {
+        std::cerr << "Can't write record " << fileName << "\n";
+
+        return 1;
+    }
+
+    modified = false;
+
+    return 0;
+}
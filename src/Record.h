@@ -0,0 +1,78 @@
+/**
+ * @file    Record.h
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'cardgen' is a playing card image generator.
+ *
+ * Interface for the Record class, the keys of the cards last drawn to an
+ * output directory.
+ */
+
+#if !defined _RECORD_H_INCLUDED_
+#define _RECORD_H_INCLUDED_
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+
+
+/**
+ * @section Record class.
+ *
+ * Used to remember the key of every card drawn to an output directory, the
+ * digest of its resolved inputs, so that a later run only draws the cards
+ * whose key has changed. The record is a journal: a line holding the key
+ * and name of a card is appended as soon as the card's .png file is in
+ * place, so an interrupted run leaves a record of every card it finished.
+ * A card that is forgotten is appended with a key of "-". The last line
+ * for a card is the one that counts, and save() rewrites the journal with
+ * only those lines.
+ */
+class Record
+{
+private:
+    static std::atomic<int> unchanged;
+
+    std::string fileName;
+    std::map<std::string, std::string> keys;
+    int fd;
+    bool modified;
+    std::mutex mutex;
+
+    void append(const std::string & key, const std::string & name);
+
+public:
+    explicit Record(const std::string & outputDirectory);
+    ~Record(void);
+    Record(const Record &) = delete;
+    void operator=(const Record &) = delete;
+
+    static bool isIncremental(void);
+    bool check(const std::string & name, const std::string & key, const std::string & outputFile);
+    void update(const std::string & name, const std::string & key);
+    void erase(const std::string & name);
+    int save(void);
+
+    static int getUnchanged(void) { return unchanged; }
+
+};
+
+
+#endif //!defined _RECORD_H_INCLUDED_
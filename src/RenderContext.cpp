@@ -0,0 +1,214 @@
+/**
+ * @file    RenderContext.cpp
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'cardgen' is a playing card image generator.
+ *
+ * Implementation for the RenderContext class.
+ */
+
+#include <algorithm>
+
+#include "cardgen.h"
+#include "RenderContext.h"
+#include "Configuration.h"
+
+
+/**
+ * @section RenderContext class method code.
+ *
+ */
+
+/**
+ * Constructor. Takes the settings from the configuration and calculates
+ * the values derived from them.
+ *
+ * @param  config - configuration to use.
+ */
+RenderContext::RenderContext(const Config & config) :
+    cardWidthPx{config.cardWidthPx},
+    cardHeightPx{config.cardHeightPx},
+    cardBorderPx{config.cardBorderPx},
+    cardColour{config.cardColour},
+
+    indexInfo{config.indexInfo},
+    cornerPipInfo{config.cornerPipInfo},
+    standardPipInfo{config.standardPipInfo},
+    imagePipInfo{config.imagePipInfo},
+
+    indexDirectory{config.indexDirectory},
+    pipDirectory{config.pipDirectory},
+    faceDirectory{config.faceDirectory},
+    outputDirectory{config.outputDirectory},
+
+    keepAspectRatio{config.keepAspectRatio},
+    mpc{config.mpc},
+    quad{config.quad},
+    layers{config.layers},
+    mirror{config.mirror},
+    filter{config.filter},
+    colours{config.colours},
+    dither{config.dither},
+    sharedPalette{config.sharedPalette},
+    pngLevel{config.pngLevel},
+    cards{config.cards},
+    shardSuffix{},
+
+    radius{},
+    strokeWidth{_strokeWidth},
+    borderOffset{_borderOffset},
+    outlineWidth{},
+    outlineHeight{},
+
+    imageBorderX{config.imageBorderX},
+    imageBorderY{config.imageBorderY},
+
+    viewportWindowX{},
+    viewportWindowY{},
+
+    imageWidth{},
+    imageHeight{},
+    imageWidthPx{},
+    imageHeightPx{},
+    imageOffsetXPx{},
+    imageOffsetYPx{},
+    imagePipScale{},
+    imageX{},
+    imageY{},
+
+    patterns{},
+    startString{},
+    startArgs{}
+{
+    // Each shard names the files it draws for itself, such as the shared
+    // layers, apart from those of the other shards.
+    if (config.shards > 1)
+        shardSuffix = "-" + std::to_string(config.shard) + "of" + std::to_string(config.shards);
+
+    recalculate();
+}
+
+/**
+ * Check if a card is to be laid out, which it is unless --cards is given
+ * without it.
+ *
+ * @param  name - name of the card.
+ * @return true if the card is selected, false otherwise.
+ */
+bool RenderContext::isSelected(const std::string & name) const
+{
+    return (cards.empty()) || (std::find(cards.begin(), cards.end(), name) != cards.end());
+}
+
+/**
+ * Generate the context used for the jokers, which use narrower borders and
+ * larger indices than the rest of the deck.
+ *
+ * @return the joker context.
+ */
+RenderContext RenderContext::getJokerContext(void) const
+{
+    RenderContext context{*this};
+    context.imageBorderX = 7;
+    context.imageBorderY = 5;
+    context.indexInfo.setH(30.0);
+    context.indexInfo.setY(20.0);
+    context.recalculate();
+
+    return context;
+}
+
+/**
+ * Calculate the values derived from the settings.
+ */
+void RenderContext::recalculate(void)
+{
+    const float cornerRadius{mpc ? 0.0F : _cornerRadius};
+
+//- Set up for Make Playing Cards output requirements.
+    if (mpc)
+    {
+        cardWidthPx  = mpcWidth;
+        cardHeightPx = mpcHeight;
+        cardBorderPx = mpcBorder;
+    }
+
+//- Card outline values in pixels.
+    radius = ROUND(cornerRadius * cardHeightPx / 100);
+    outlineWidth = cardWidthPx-borderOffset-1;
+    outlineHeight = cardHeightPx-borderOffset-1;
+
+//- Calculate viewport window size as percentages of the card size. In this
+//  context the viewport is the area of the card not occupied by the standard
+//  pip borders.
+    viewportWindowX = (100.0F - (2.0F * standardPipInfo.getX()));
+    viewportWindowY = (100.0F - (2.0F * standardPipInfo.getY()));
+
+//- Card face image values in pixels.
+    imageWidth  = 100 - (2 * imageBorderX);
+    imageHeight = 50 - imageBorderY;
+    imageWidthPx    = ROUND(imageWidth * cardWidthPx / 100);
+    imageHeightPx   = ROUND(imageHeight * cardHeightPx / 100);
+    imageOffsetXPx  = ROUND(imageBorderX * cardWidthPx / 100);
+    imageOffsetYPx  = ROUND(imageBorderY * cardHeightPx / 100);
+
+    const float scaleX{imageWidth/_originalImageWidth};
+    const float scaleY{imageHeight/_originalImageHeight};
+    imagePipScale = (scaleX < scaleY) ? scaleX : scaleY;
+
+    imageX      = 50;
+    imageY      = imageBorderY + (imageHeight / 2);
+
+    patterns = PatternCollection{viewportWindowX, viewportWindowY};
+    startString = genStartString(*this);
+    startArgs = genStartArgs(*this);
+}
+
+/**
+ * display function for RenderContext class.
+ *
+ * @param  os - output stream.
+ */
+void RenderContext::display(std::ostream &os) const
+{
+	os << "cardWidthPx\t" << cardWidthPx << "\n";
+	os << "cardHeightPx\t" << cardHeightPx << "\n";
+	os << "cardBorderPx\t" << cardBorderPx << "\n";
+	os << "\n";
+	os << "radius\t\t" << radius << "\n";
+	os << "strokeWidth\t" << strokeWidth << "\n";
+	os << "borderOffset\t" << borderOffset << "\n";
+	os << "outlineWidth\t" << outlineWidth << "\n";
+	os << "outlineHeight\t" << outlineHeight << "\n";
+	os << "\n";
+	os << "viewportWindowX\t" << viewportWindowX << "\n";
+	os << "viewportWindowY\t" << viewportWindowY << "\n";
+	os << "\n";
+	os << "imageWidth\t" << imageWidth << "\n";
+	os << "imageHeight\t" << imageHeight << "\n";
+	os << "imageWidthPx\t" << imageWidthPx << "\n";
+	os << "imageHeightPx\t" << imageHeightPx << "\n";
+	os << "imageOffsetXPx\t" << imageOffsetXPx << "\n";
+	os << "imageOffsetYPx\t" << imageOffsetYPx << "\n";
+	os << "\n";
+	os << "imagePipScale\t" << imagePipScale << "\n";
+	os << "imageX\t\t" << imageX << "\n";
+	os << "imageY\t\t" << imageY << "\n";
+}
+
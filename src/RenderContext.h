@@ -0,0 +1,176 @@
+/**
+ * @file    RenderContext.h
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'cardgen' is a playing card image generator.
+ *
+ * Interface for the RenderContext class, the settings used to lay out a
+ * single deck.
+ */
+
+#if !defined _RENDERCONTEXT_H_INCLUDED_
+#define _RENDERCONTEXT_H_INCLUDED_
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "desc.h"
+#include "Loc.h"
+#include "Resample.h"
+#include "Quantize.h"
+#include "PngWriter.h"
+
+class Config;
+
+
+/**
+ * @section RenderContext class.
+ *
+ * Used to hold every value needed to lay out and draw a deck, including
+ * those derived from the configuration. A context is not changed once it
+ * has been made, so any number of decks can be laid out at the same time,
+ * each with its own context. The jokers use a variant of the context of
+ * their deck.
+ */
+class RenderContext
+{
+private:
+    int cardWidthPx;
+    int cardHeightPx;
+    int cardBorderPx;
+    std::string cardColour;
+
+    info indexInfo;
+    info cornerPipInfo;
+    info standardPipInfo;
+    info imagePipInfo;
+
+    std::string indexDirectory;
+    std::string pipDirectory;
+    std::string faceDirectory;
+    std::string outputDirectory;
+
+    bool keepAspectRatio;
+    bool mpc;
+    bool quad;
+    bool layers;
+    bool mirror;
+    Resample::Filter filter;
+    int colours;
+    Quantize::Dither dither;
+    bool sharedPalette;
+    PngWriter::Level pngLevel;
+    std::vector<std::string> cards;
+    std::string shardSuffix;
+
+    int radius;
+    int strokeWidth;
+    int borderOffset;
+    int outlineWidth;
+    int outlineHeight;
+
+    float imageBorderX;
+    float imageBorderY;
+
+    float viewportWindowX;
+    float viewportWindowY;
+
+    float imageWidth;
+    float imageHeight;
+    int imageWidthPx;
+    int imageHeightPx;
+    int imageOffsetXPx;
+    int imageOffsetYPx;
+    float imagePipScale;
+    float imageX;
+    float imageY;
+
+    PatternCollection patterns;
+    std::string startString;
+    std::vector<std::string> startArgs;
+
+    void recalculate(void);
+    void display(std::ostream &os) const;
+
+public:
+    RenderContext(const Config & config);
+
+    RenderContext getJokerContext(void) const;
+
+    int getCardWidthPx(void) const { return cardWidthPx; }
+    int getCardHeightPx(void) const { return cardHeightPx; }
+    int getCardBorderPx(void) const { return cardBorderPx; }
+    const std::string & getCardColour(void) const { return cardColour; }
+
+    const info & getIndexInfo(void) const { return indexInfo; }
+    const info & getCornerPipInfo(void) const { return cornerPipInfo; }
+    const info & getStandardPipInfo(void) const { return standardPipInfo; }
+    float getStandardPipX(void) const { return standardPipInfo.getX(); }
+    float getStandardPipY(void) const { return standardPipInfo.getY(); }
+    const info & getImagePipInfo(void) const { return imagePipInfo; }
+    float getImagePipH(void) const { return imagePipInfo.getH(); }
+
+    const std::string & getIndexDirectory(void) const { return indexDirectory; }
+    const std::string & getPipDirectory(void) const { return pipDirectory; }
+    const std::string & getFaceDirectory(void) const { return faceDirectory; }
+    const std::string & getOutputDirectory(void) const { return outputDirectory; }
+
+    bool isKeepAspectRatio(void) const { return keepAspectRatio; }
+    bool isMpc(void) const { return mpc; }
+    bool isQuad(void) const { return quad; }
+    bool isLayers(void) const { return layers; }
+    bool isMirror(void) const { return mirror; }
+    Resample::Filter getFilter(void) const { return filter; }
+    int getColours(void) const { return colours; }
+    Quantize::Dither getDither(void) const { return dither; }
+    bool isSharedPalette(void) const { return sharedPalette && (colours > 0); }
+    PngWriter::Level getPngLevel(void) const { return pngLevel; }
+    bool isSelected(const std::string & name) const;
+    const std::string & getShardSuffix(void) const { return shardSuffix; }
+
+    int getRadius(void) const { return radius; }
+    int getStrokeWidth(void) const { return strokeWidth; }
+    int getBorderOffset(void) const { return borderOffset; }
+    int getOutlineWidth(void) const { return outlineWidth; }
+    int getOutlineHeight(void) const { return outlineHeight; }
+
+    float getViewportWindowX(void) const { return viewportWindowX; }
+    float getViewportWindowY(void) const { return viewportWindowY; }
+
+    float getImageHeight(void) const { return imageHeight; }
+    int getImageWidthPx(void) const { return imageWidthPx; }
+    int getImageHeightPx(void) const { return imageHeightPx; }
+    int getImageOffsetXPx(void) const { return imageOffsetXPx; }
+    int getImageOffsetYPx(void) const { return imageOffsetYPx; }
+    float getImagePipScale(void) const { return imagePipScale; }
+    float getImageX(void) const { return imageX; }
+    float getImageY(void) const { return imageY; }
+
+    const PatternCollection & getPatterns(void) const { return patterns; }
+    const std::string & getStartString(void) const { return startString; }
+    const std::vector<std::string> & getStartArgs(void) const { return startArgs; }
+
+    friend std::ostream & operator<<(std::ostream &os, const RenderContext &A) { A.display(os); return os; }
+
+};
+
+
+#endif //!defined _RENDERCONTEXT_H_INCLUDED_
+
@@ -0,0 +1,261 @@
+/**
+ * @file    Resample.cpp
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'cardgen' is a playing card image generator.
+ *
+ * Implementation for the Resample class.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "Resample.h"
+
+
+/**
+ * @section Internal constants and variables.
+ *
+ */
+
+static const float pi{3.14159265358979F};
+
+std::mutex Resample::mutex{};
+std::map<std::tuple<Resample::Filter, int, int>, std::unique_ptr<const Resample::Weights>> Resample::cache{};
+
+
+/**
+ * @section Internal support code.
+ *
+ */
+
+/**
+ * Calculate sin(pi x) / (pi x).
+ *
+ * @param  x - distance from the centre.
+ * @return the value of the function.
+ */
+static float sinc(float x)
+{
+    if (x == 0.0F)
+        return 1.0F;
+
+    x *= pi;
+
+    return std::sin(x) / x;
+}
+
+/**
+ * Calculate the Lanczos kernel with 3 lobes.
+ *
+ * @param  x - distance from the centre.
+ * @return the value of the kernel.
+ */
+static float lanczos3(float x)
+{
+    if (x >= 3.0F)
+        return 0.0F;
+
+    return sinc(x) * sinc(x / 3.0F);
+}
+
+
+/**
+ * @section Resample class method code.
+ *
+ */
+
+/**
+ * Look up a filter by name.
+ *
+ * @param  name - name of the filter.
+ * @param  filter - set to the filter if found.
+ * @return true if the filter was found, false otherwise.
+ */
+bool Resample::parseFilter(const std::string & name, Filter & filter)
+{
+    if (name == "bilinear")
+        filter = Filter::BILINEAR;
+    else
+    if (name == "lanczos3")
+        filter = Filter::LANCZOS3;
+    else
+        return false;
+
+    return true;
+}
+
+/**
+ * Get the name of a filter.
+ *
+ * @param  filter - the filter.
+ * @return the name of the filter.
+ */
+std::string Resample::getFilterName(Filter filter)
+{
+    return (filter == Filter::LANCZOS3) ? "lanczos3" : "bilinear";
+}
+
+/**
+ * Calculate the weights for resizing along one axis. The support of the
+ * filter is widened when reducing so that every source pixel contributes.
+ * The weights for each destination pixel are normalised to sum to 1.
+ *
+ * @param  filter - filter to use.
+ * @param  src - size of the source.
+ * @param  dst - size of the destination.
+ * @return the weights.
+ */
+std::unique_ptr<const Resample::Weights> Resample::calculate(Filter filter, int src, int dst)
+{
+    const float scale{float(src) / dst};
+    const float stretch{std::max(1.0F, scale)};
+    const float support{(filter == Filter::LANCZOS3) ? 3.0F * stretch : stretch};
+    const int taps{int(std::ceil(support * 2)) + 1};
+
+    auto weights{std::make_unique<Weights>(Weights{taps, std::vector<int>(dst), std::vector<int>(dst), std::vector<float>(size_t(dst) * taps)})};
+    for (int d{}; d < dst; ++d)
+    {
+        const float centre{((d + 0.5F) * scale) - 0.5F};
+        const int first{std::max(0, int(std::floor(centre - support)) + 1)};
+        const int last{std::min(std::min(src - 1, int(std::ceil(centre + support)) - 1), first + taps - 1)};
+
+        float * values{weights->values.data() + (size_t(d) * taps)};
+        float total{};
+        for (int i{first}; i <= last; ++i)
+        {
+            const float distance{std::fabs(i - centre) / stretch};
+            const float weight{(filter == Filter::LANCZOS3) ? lanczos3(distance) : std::max(0.0F, 1.0F - distance)};
+            values[i - first] = weight;
+            total += weight;
+        }
+
+        if (total != 0)
+            for (int i{first}; i <= last; ++i)
+                values[i - first] /= total;
+
+        weights->first[d] = first;
+        weights->count[d] = std::max(0, last - first + 1);
+    }
+
+    return weights;
+}
+
+/**
+ * Get the weights for resizing along one axis, calculating them on first
+ * use.
+ *
+ * @param  filter - filter to use.
+ * @param  src - size of the source.
+ * @param  dst - size of the destination.
+ * @return the weights.
+ */
+const Resample::Weights & Resample::getWeights(Filter filter, int src, int dst)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    auto & weights{cache[std::make_tuple(filter, src, dst)]};
+    if (!weights)
+        weights = calculate(filter, src, dst);
+
+    return *weights;
+}
+
+/**
+ * Resize a row of RGBA pixels horizontally into floating point channels.
+ *
+ * @param  dst - destination channels, 4 for each destination pixel.
+ * @param  src - source pixels.
+ * @param  weights - weights for the horizontal axis.
+ */
+void Resample::horizontal(float * dst, const uint8_t * src, const Weights & weights)
+{
+    const int width{int(weights.first.size())};
+    for (int x{}; x < width; ++x, dst += 4)
+    {
+        const float * values{weights.values.data() + (size_t(x) * weights.taps)};
+        const uint8_t * pixel{src + (weights.first[x] * 4)};
+        const int count{weights.count[x]};
+#if defined(__SSE2__)
+        const __m128i zero{_mm_setzero_si128()};
+        __m128 sum{_mm_setzero_ps()};
+        for (int i{}; i < count; ++i, pixel += 4)
+        {
+            int32_t value{};
+            std::memcpy(&value, pixel, 4);
+            const __m128i channels{_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(value), zero), zero)};
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(values[i]), _mm_cvtepi32_ps(channels)));
+        }
+        _mm_storeu_ps(dst, sum);
+#elif defined(__ARM_NEON)
+        float32x4_t sum{vdupq_n_f32(0.0F)};
+        for (int i{}; i < count; ++i, pixel += 4)
+        {
+            const float32x4_t channels{float(pixel[0]), float(pixel[1]), float(pixel[2]), float(pixel[3])};
+            sum = vaddq_f32(sum, vmulq_f32(vdupq_n_f32(values[i]), channels));
+        }
+        vst1q_f32(dst, sum);
+#else
+        float sum[4]{};
+        for (int i{}; i < count; ++i, pixel += 4)
+            for (int j{}; j < 4; ++j)
+                sum[j] += values[i] * pixel[j];
+        std::copy(sum, sum + 4, dst);
+#endif
+    }
+}
+
+/**
+ * Combine consecutive rows of floating point channels vertically, as the
+ * weighted sum of the source rows.
+ *
+ * @param  dst - destination channels.
+ * @param  src - first source row.
+ * @param  stride - number of channels from one source row to the next.
+ * @param  values - weight of each source row.
+ * @param  count - number of source rows.
+ * @param  length - number of channels in a row.
+ */
+void Resample::vertical(float * dst, const float * src, size_t stride, const float * values, int count, int length)
+{
+    std::fill(dst, dst + length, 0.0F);
+    for (int i{}; i < count; ++i)
+    {
+        const float * row{src + (i * stride)};
+        int k{};
+#if defined(__SSE2__)
+        const __m128 weight{_mm_set1_ps(values[i])};
+        for (; k + 4 <= length; k += 4)
+            _mm_storeu_ps(dst + k, _mm_add_ps(_mm_loadu_ps(dst + k), _mm_mul_ps(weight, _mm_loadu_ps(row + k))));
+#elif defined(__ARM_NEON)
+        const float32x4_t weight{vdupq_n_f32(values[i])};
+        for (; k + 4 <= length; k += 4)
+            vst1q_f32(dst + k, vaddq_f32(vld1q_f32(dst + k), vmulq_f32(weight, vld1q_f32(row + k))));
+#endif
+        for (; k < length; ++k)
+            dst[k] += values[i] * row[k];
+    }
+}
+
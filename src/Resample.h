@@ -0,0 +1,83 @@
+/**
+ * @file    Resample.h
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'cardgen' is a playing card image generator.
+ *
+ * Interface for the Resample class, the filters used to resize images.
+ */
+
+#if !defined _RESAMPLE_H_INCLUDED_
+#define _RESAMPLE_H_INCLUDED_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+
+/**
+ * @section Resample class.
+ *
+ * Used to resize images with a separable filter. The weights of the source
+ * pixels that contribute to each destination pixel depend only on the
+ * filter and the source and destination sizes, so each table of weights is
+ * calculated once and shared by every image resized between those sizes.
+ */
+class Resample
+{
+public:
+    enum class Filter { BILINEAR, LANCZOS3 };
+
+    /**
+     * The weights for resizing along one axis. Destination pixel d is the
+     * sum of count[d] source pixels starting at first[d], weighted by the
+     * values starting at values[d * taps].
+     */
+    struct Weights
+    {
+        int taps;
+        std::vector<int> first;
+        std::vector<int> count;
+        std::vector<float> values;
+    };
+
+private:
+    static std::mutex mutex;
+    static std::map<std::tuple<Filter, int, int>, std::unique_ptr<const Weights>> cache;
+
+    static std::unique_ptr<const Weights> calculate(Filter filter, int src, int dst);
+
+public:
+    static bool parseFilter(const std::string & name, Filter & filter);
+    static std::string getFilterName(Filter filter);
+    static const Weights & getWeights(Filter filter, int src, int dst);
+
+    static void horizontal(float * dst, const uint8_t * src, const Weights & weights);
+    static void vertical(float * dst, const float * src, size_t stride, const float * values, int count, int length);
+
+};
+
+
+#endif //!defined _RESAMPLE_H_INCLUDED_
+
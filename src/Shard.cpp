@@ -0,0 +1,108 @@
+/**
+ * @file    Shard.cpp
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'cardgen' is a playing card image generator.
+ *
+ * Implementation for the Shard class.
+ */
+
+#include <algorithm>
+#include <numeric>
+
+#include "cardgen.h"
+#include "Shard.h"
+#include "Configuration.h"
+
+
+/**
+ * @section Shard class method code.
+ *
+ */
+
+/**
+ * Check if only a share of the cards is to be drawn.
+ *
+ * @return true if sharded, false otherwise.
+ */
+bool Shard::isEnabled(void)
+{
+    return Config::getShards() > 1;
+}
+
+/**
+ * Select the tasks of this shard. The tasks are taken most expensive first,
+ * in their given order when costs are equal, and each is given to the shard
+ * with the least total cost so far, the lowest numbered on a tie.
+ *
+ * @param  costs - estimated cost of each task, in a fixed order.
+ * @return true for each task in this shard.
+ */
+std::vector<bool> Shard::select(const std::vector<long> & costs)
+{
+    const size_t shards{size_t(Config::getShards())};
+    const size_t shard{size_t(Config::getShard()) - 1};
+    if (shards < 2)
+        return std::vector<bool>(costs.size(), true);
+
+    std::vector<size_t> order(costs.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&costs](size_t a, size_t b) { return costs[a] > costs[b]; });
+
+    std::vector<long> totals(shards);
+    std::vector<bool> selected(costs.size());
+    for (const auto task : order)
+    {
+        const size_t least{size_t(std::min_element(totals.begin(), totals.end()) - totals.begin())};
+        totals[least] += costs[task];
+        selected[task] = (least == shard);
+    }
+
+    return selected;
+}
+
+/**
+ * Remove the cards that are not in this shard from every deck. The cards
+ * of all the decks are split together, in the order they are laid out, so
+ * the shards of a batch are balanced as a whole.
+ *
+ * @param  decks - laid out decks, set to the cards of this shard.
+ */
+void Shard::select(std::vector<Deck> & decks)
+{
+    if (!isEnabled())
+        return;
+
+    std::vector<long> costs{};
+    for (const auto & deck : decks)
+        for (const auto & card : deck)
+            costs.push_back(card.estimateCost());
+
+    const auto selected{select(costs)};
+    size_t i{};
+    for (auto & deck : decks)
+    {
+        Deck cards{};
+        for (auto & card : deck)
+            if (selected[i++])
+                cards.push_back(std::move(card));
+        deck = std::move(cards);
+    }
+}
+
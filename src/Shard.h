@@ -0,0 +1,53 @@
+/**
+ * @file    Shard.h
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'cardgen' is a playing card image generator.
+ *
+ * Interface for the Shard class, used to split the cards between processes.
+ */
+
+#if !defined _SHARD_H_INCLUDED_
+#define _SHARD_H_INCLUDED_
+
+#include <vector>
+
+#include "Card.h"
+
+
+/**
+ * @section Shard class.
+ *
+ * Used to pick the cards drawn by one of several independent processes
+ * given --shard i/n. Every process lays out the same decks, so each makes
+ * the same deterministic split of the cards, balanced by their estimated
+ * cost, without needing to coordinate with the others.
+ */
+class Shard
+{
+public:
+    static bool isEnabled(void);
+    static std::vector<bool> select(const std::vector<long> & costs);
+    static void select(std::vector<Deck> & decks);
+
+};
+
+
+#endif //!defined _SHARD_H_INCLUDED_
+
@@ -0,0 +1,166 @@
+/**
+ * @file    Sprites.cpp
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'cardgen' is a playing card image generator.
+ *
+ * Implementation for the Sprites class.
+ */
+
+#include "cardgen.h"
+#include "Sprites.h"
+#include "Configuration.h"
+
+
+/**
+ * @section Internal constants and variables.
+ *
+ */
+
+std::mutex Sprites::mutex{};
+std::list<Sprites::Entry> Sprites::entries{};
+std::map<Sprites::Key, std::list<Sprites::Entry>::iterator> Sprites::index{};
+size_t Sprites::bytes{};
+int Sprites::hits{};
+int Sprites::misses{};
+
+
+/**
+ * @section Internal support code.
+ *
+ */
+
+/**
+ * Get the memory used by the pixels of a sprite.
+ *
+ * @param  sprite - the sprite.
+ * @return the number of bytes used.
+ */
+static size_t getSize(const Canvas & sprite)
+{
+    return size_t(sprite.getWidth()) * sprite.getHeight() * 4;
+}
+
+
+/**
+ * @section Sprites class method code.
+ *
+ */
+
+/**
+ * Check if the sprite cache has a budget to work with.
+ *
+ * @return true if enabled, false otherwise.
+ */
+bool Sprites::isEnabled(void)
+{
+    return Config::getSpriteCache() > 0;
+}
+
+/**
+ * Look up a sprite, marking it as the most recently used.
+ *
+ * @param  key - file name, size, rotation and filter of the sprite.
+ * @return the sprite, or nullptr if it isn't in the cache.
+ */
+std::shared_ptr<const Canvas> Sprites::find(const Key & key)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    const auto it{index.find(key)};
+    if (it == index.end())
+    {
+        ++misses;
+
+        return nullptr;
+    }
+
+    ++hits;
+    entries.splice(entries.begin(), entries, it->second);
+
+    return it->second->second;
+}
+
+/**
+ * Add a sprite to the cache, discarding the least recently used sprites
+ * until the cache is back within its budget. If another thread added the
+ * same sprite first, that one is kept instead. Sprites still being drawn
+ * by other threads remain valid after they are discarded.
+ *
+ * @param  key - file name, size, rotation and filter of the sprite.
+ * @param  sprite - the scaled image.
+ * @return the cached sprite.
+ */
+std::shared_ptr<const Canvas> Sprites::insert(const Key & key, std::shared_ptr<const Canvas> sprite)
+{
+    const size_t budget{size_t(Config::getSpriteCache()) * 1024 * 1024};
+
+    std::lock_guard<std::mutex> lock{mutex};
+    const auto it{index.find(key)};
+    if (it != index.end())
+        return it->second->second;
+
+    entries.emplace_front(key, sprite);
+    index[key] = entries.begin();
+    bytes += getSize(*sprite);
+
+    while ((bytes > budget) && (!entries.empty()))
+    {
+        bytes -= getSize(*entries.back().second);
+        index.erase(entries.back().first);
+        entries.pop_back();
+    }
+
+    return sprite;
+}
+
+/**
+ * Discard all the sprites.
+ */
+void Sprites::clear(void)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    index.clear();
+    entries.clear();
+    bytes = 0;
+}
+
+/**
+ * Get the number of sprites found in the cache.
+ *
+ * @return the number of hits.
+ */
+int Sprites::getHits(void)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    return hits;
+}
+
+/**
+ * Get the number of sprites that had to be scaled.
+ *
+ * @return the number of misses.
+ */
+int Sprites::getMisses(void)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    return misses;
+}
+
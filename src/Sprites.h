@@ -0,0 +1,76 @@
+/**
+ * @file    Sprites.h
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'cardgen' is a playing card image generator.
+ *
+ * Interface for the Sprites class, the cache of scaled component images.
+ */
+
+#if !defined _SPRITES_H_INCLUDED_
+#define _SPRITES_H_INCLUDED_
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+#include "Canvas.h"
+#include "Resample.h"
+
+
+/**
+ * @section Sprites class.
+ *
+ * Used to hold the component images already scaled to the size they are
+ * drawn at, so an image drawn at the same size many times, such as the
+ * standard pips of a suit, is only scaled once. The least recently used
+ * sprites are discarded to keep within the budget set by --sprite-cache.
+ */
+class Sprites
+{
+public:
+    using Key = std::tuple<std::string, int, int, bool, Resample::Filter>;
+
+private:
+    using Entry = std::pair<Key, std::shared_ptr<const Canvas>>;
+
+    static std::mutex mutex;
+    static std::list<Entry> entries;
+    static std::map<Key, std::list<Entry>::iterator> index;
+    static size_t bytes;
+    static int hits;
+    static int misses;
+
+public:
+    static bool isEnabled(void);
+    static std::shared_ptr<const Canvas> find(const Key & key);
+    static std::shared_ptr<const Canvas> insert(const Key & key, std::shared_ptr<const Canvas> sprite);
+    static void clear(void);
+
+    static int getHits(void);
+    static int getMisses(void);
+
+};
+
+
+#endif //!defined _SPRITES_H_INCLUDED_
+
@@ -0,0 +1,313 @@
+/**
+ * @file    bench.cpp
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'cardgen' is a playing card image generator.
+ *
+ * Microbenchmarks for the layout and script generation code. Built and run
+ * using 'make bench'. Any arguments are passed on to the configuration, so
+ * for example 'cardbench -m -q' benchmarks the MPC and quad layouts.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include <filesystem>
+
+#include <unistd.h>
+
+#include "cardgen.h"
+#include "Canvas.h"
+#include "Blend.h"
+#include "Resample.h"
+#include "PngWriter.h"
+#include "RenderContext.h"
+#include "Configuration.h"
+
+
+/**
+ * @section Allocation counting.
+ *
+ * Every allocation made by the program goes through these, so the number
+ * made by each benchmark can be reported.
+ */
+
+static std::atomic<long> allocations{};
+
+void * operator new(std::size_t size)
+{
+    ++allocations;
+    void * p{std::malloc(size ? size : 1)};
+    if (!p)
+        throw std::bad_alloc{};
+
+    return p;
+}
+
+void operator delete(void * p) noexcept { std::free(p); }
+void operator delete(void * p, std::size_t) noexcept { std::free(p); }
+
+
+/**
+ * @section Internal constants and variables.
+ *
+ */
+
+static const int repeats{5};
+
+/**
+ * An output stream buffer that discards everything written to it, so that
+ * the cost of generating the script can be measured without any I/O.
+ */
+class NullBuffer : public std::streambuf
+{
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char *, std::streamsize n) override { return n; }
+
+};
+
+static volatile long sink{};
+
+
+/**
+ * @section Support code.
+ *
+ */
+
+/**
+ * Time a benchmark. The function is called once to warm up, then the given
+ * number of times in each of several repeats. The fastest repeat is reported
+ * as it is the least disturbed by the rest of the system.
+ *
+ * @param  name - name of benchmark.
+ * @param  iterations - number of calls per repeat.
+ * @param  fn - function to benchmark.
+ */
+static void bench(const std::string & name, int iterations, const std::function<void(void)> & fn)
+{
+    fn();
+
+    double best{};
+    long allocs{};
+    for (int r{}; r < repeats; ++r)
+    {
+        const long before{allocations};
+        const auto start{std::chrono::steady_clock::now()};
+        for (int i{}; i < iterations; ++i)
+            fn();
+        const auto stop{std::chrono::steady_clock::now()};
+
+        const double ns{std::chrono::duration<double, std::nano>(stop - start).count() / iterations};
+        if ((!r) || (ns < best))
+            best = ns;
+        allocs = allocations - before;
+    }
+
+    std::cout << std::left << std::setw(32) << name << std::right
+        << std::setw(12) << std::fixed << std::setprecision(1) << best << " ns/op"
+        << std::setw(10) << std::setprecision(1) << double(allocs) / iterations << " allocs/op\n";
+}
+
+/**
+ * Write a plain image file for use as a component image.
+ *
+ * @param  fileName - name of image file.
+ * @param  width - width of image.
+ * @param  height - height of image.
+ */
+static void genImage(const std::string & fileName, int width, int height)
+{
+    Canvas image{width, height};
+    Canvas::Pixel colour{};
+    Canvas::parseColour("black", colour);
+    image.rectangle(0, 0, width - 1, height - 1, 0, colour, colour, 0);
+
+    std::filesystem::create_directories(std::filesystem::path{fileName}.parent_path());
+    image.save(fileName);
+}
+
+/**
+ * Generate a minimal set of component images in the current directory.
+ */
+static void genAssets(void)
+{
+    const std::vector<std::string> suits{ "C", "D", "H", "S" };
+    const std::vector<std::string> cards{ "A", "2", "3", "4", "5", "6", "7", "8", "9", "10", "J", "Q", "K" };
+
+    for (const auto & suit : suits)
+    {
+        genImage(_pipBase + "/" + _pipDirectory + "/" + suit + ".png", 80, 94);
+
+        for (const auto & card : cards)
+            genImage(_indexBase + "/" + _indexDirectory + "/" + suit + card + ".png", 40, 72);
+
+        for (const auto & card : { "J", "Q", "K" })
+            genImage(_faceBase + "/" + _faceDirectory + "/" + suit + card + ".png", 270, 424);
+    }
+
+    genImage(_boneyardBase + "/Back.png", 200, 300);
+}
+
+/**
+ * @section main code.
+ *
+ */
+
+/**
+ * System entry point.
+ *
+ * @param  argc - command line argument count.
+ * @param  argv - command line argument vector.
+ * @return error value or 0 if no errors.
+ */
+int main(int argc, char *argv[])
+{
+//- Work in a temporary directory holding generated component images.
+    const auto previous{std::filesystem::current_path()};
+    const auto directory{std::filesystem::temp_directory_path() / ("cardbench." + std::to_string(getpid()))};
+    std::filesystem::create_directories(directory);
+    std::filesystem::current_path(directory);
+    genAssets();
+
+    // Use the default directories if no arguments are given, as the
+    // configuration requires at least one.
+    std::vector<char *> args{ argv, argv + argc };
+    char option[]{"-I"};
+    char value[]{"1"};
+    if (argc < 2)
+        args.insert(args.end(), { option, value });
+
+    if (Config::instance().init(args.size(), args.data()))
+    {
+        std::filesystem::current_path(previous);
+        std::filesystem::remove_all(directory);
+
+        return 1;
+    }
+
+    const RenderContext context{Config::instance()};
+    const std::string pipFile{context.getPipDirectory() + "C.png"};
+    const std::string faceFile{context.getFaceDirectory() + "CK.png"};
+    const std::string missingFile{context.getPipDirectory() + "missing.png"};
+
+//- Run the benchmarks.
+    bench("desc (file found)", 100000, [&]() {
+        desc d{context, context.getStandardPipInfo(), pipFile};
+        sink = sink + d.isFileFound();
+    });
+
+    bench("desc (file missing)", 100000, [&]() {
+        desc d{context, context.getStandardPipInfo(), missingFile};
+        sink = sink + d.isFileFound();
+    });
+
+    desc pipD{context, context.getStandardPipInfo(), pipFile};
+    bench("desc::reposition (genDrawString)", 1000000, [&]() {
+        pipD.reposition(50, 50);
+        sink = sink + pipD.draw().getX();
+    });
+
+    bench("PatternCollection", 10000, [&]() {
+        PatternCollection patterns{context.getViewportWindowX(), context.getViewportWindowY()};
+        sink = sink + patterns.isIndex(10);
+    });
+
+    bench("drawStandardPips (10)", 100000, [&]() {
+        sink = sink + drawStandardPips(context, true, 10, pipD).size();
+    });
+
+    const desc faceD{context, context.getImageHeight(), context.getImageX(), context.getImageY(), faceFile};
+    bench("drawImage (court)", 100000, [&]() {
+        sink = sink + drawImage(context, faceD, pipFile).size();
+    });
+
+    bench("layoutDeck", 1000, [&]() {
+        sink = sink + layoutDeck(context).size();
+    });
+
+//- Check each blend kernel against the scalar reference and time it.
+    const int mismatches{Blend::check()};
+    std::mt19937 random{1};
+    std::vector<uint8_t> source(1024 * 4);
+    std::vector<uint8_t> target(1024 * 4);
+    for (size_t i{}; i < source.size(); i += 4)
+    {
+        source[i+3] = uint8_t(random());
+        for (int j{}; j < 3; ++j)
+            source[i+j] = uint8_t(random() % (source[i+3] + 1U));
+    }
+    for (auto & value : target)
+        value = uint8_t(random());
+
+    for (const auto & kernel : Blend::getKernels())
+    {
+        std::vector<uint8_t> output{target};
+        bench("Blend::" + kernel.name + " (1024 px)", 100000, [&]() {
+            kernel.row(output.data(), source.data(), 1024);
+        });
+    }
+
+//- Time decoding a face image, then resizing it with each filter.
+    Canvas face{};
+    bench("Canvas::load (face)", 1000, [&]() {
+        sink = sink + face.load(faceFile);
+    });
+
+    Canvas sprite{};
+    std::vector<float> temp{};
+    for (const auto filter : { Resample::Filter::BILINEAR, Resample::Filter::LANCZOS3 })
+        bench("Canvas::resize (" + Resample::getFilterName(filter) + ")", 100, [&]() {
+            face.resize(context.getImageWidthPx(), context.getImageHeightPx(), sprite, temp, filter);
+        });
+
+//- Time encoding a card at each level.
+    Canvas card{context.getCardWidthPx(), context.getCardHeightPx()};
+    Canvas::Pixel white{};
+    Canvas::parseColour("white", white);
+    card.rectangle(0, 0, card.getWidth() - 1, card.getHeight() - 1, 20, white, white, 0);
+    card.over(sprite, context.getImageOffsetXPx(), context.getImageOffsetYPx());
+    for (const auto level : { PngWriter::Level::FAST, PngWriter::Level::DEFAULT, PngWriter::Level::MAX })
+        bench("PngWriter::write (" + PngWriter::getLevelName(level) + ")", 20, [&]() {
+            size_t bytes{};
+            PngWriter::write("card.png", card, level, bytes);
+            sink = sink + long(bytes);
+        });
+
+    const std::vector<RenderContext> decks{context};
+    NullBuffer buffer{};
+    std::ostream null{&buffer};
+    bench("writeScript", 1000, [&]() {
+        sink = sink + writeScript(null, decks, args.size(), args.data());
+    });
+
+    std::filesystem::current_path(previous);
+    std::filesystem::remove_all(directory);
+
+    return mismatches ? 1 : 0;
+}
+
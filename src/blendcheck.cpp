@@ -0,0 +1,44 @@
+/**
+ * @file    blendcheck.cpp
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'cardgen' is a playing card image generator.
+ *
+ * Checks that every blend kernel available on this processor gives exactly
+ * the same result as the scalar reference. Built and run by 'make check'.
+ */
+
+#include <iostream>
+
+#include "Blend.h"
+
+
+/**
+ * System entry point.
+ *
+ * @return error value or 0 if no errors.
+ */
+int main(void)
+{
+    const int mismatches{Blend::check()};
+    std::cout << Blend::getKernels().size() << " blend kernels checked, " << mismatches << " differ from the scalar reference.\n";
+
+    return mismatches ? 1 : 0;
+}
+
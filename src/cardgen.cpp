@@ -26,6 +26,7 @@
 #include "cardgen.h"
 #include <sys/stat.h>
 #include "Configuration.h"
+#include "Assets.h"
 
 
 /**
@@ -49,13 +50,29 @@ int main(int argc, char *argv[])
     else if (ret > 0)
         return 0;
 
-    if (!Config::isValid(true))
+    if (Config::isBuildIndex())
+        return Assets::buildIndex({ _indexBase, _pipBase, _faceBase, _boneyardBase });
+
+    if ((!Config::isBatch()) && (!Config::isValid(true)))
         return 1;
 
-//- If all is well, generate the script.
+//- If all is well, render the cards or generate the script.
     if (!ret)
     {
-        generateScript(argc, argv);
+        if (Config::isSweep())
+            return sweepCards(argc, argv);
+
+        if (Config::isRender())
+            return renderCards(argc, argv);
+
+        if (Config::isMakefile())
+            return generateMakefile(argc, argv);
+
+        if (Config::isJobs())
+            return runJobs(argc, argv);
+
+        if (generateScript(argc, argv))
+            return 1;
 
         // Ensure output scripts are executable.
         chmod(Config::getScriptFilename().c_str(), S_IRWXU|S_IRGRP|S_IXGRP|S_IROTH|S_IXOTH);
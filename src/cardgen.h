@@ -27,7 +27,14 @@
 #define _CARDGEN_H_INCLUDED_
 
 #include <string>
+#include <vector>
 #include "desc.h"
+#include "Card.h"
+#include "Resample.h"
+#include "Quantize.h"
+#include "PngWriter.h"
+
+class RenderContext;
 
 #if !defined ROUND
 #define ROUND(v) (int)((v) + 0.5)
@@ -52,6 +59,7 @@ const std::string _indexBase{"indices"};
 const std::string _pipBase{"pips"};
 const std::string _faceBase{"faces"};
 const std::string _outputBase{"cards"};
+const std::string _boneyardBase{"boneyard"};
 
 const std::string _indexDirectory{"1"};
 const std::string _pipDirectory{"1"};
@@ -59,6 +67,16 @@ const std::string _faceDirectory{"1"};
 
 const std::string _scriptFilename{"draw.sh"};
 const std::string _refreshFilename{"x_refresh.sh"};
+const std::string _makeFilename{"draw.mk"};
+const std::string _convertProgram{"convert"};
+const std::string _assetIndexFilename{".cardgen.idx"};
+const std::string _recordFilename{".cardgen.cards"};
+const int _retries{1};
+const Resample::Filter _filter{Resample::Filter::BILINEAR};
+const int _spriteCache{256};
+const int _colours{};
+const Quantize::Dither _dither{Quantize::Dither::NONE};
+const PngWriter::Level _pngLevel{PngWriter::Level::DEFAULT};
 
 const bool _keepAspectRatio{};
 const bool _mpc{};
@@ -82,7 +100,22 @@ const float _originalImageHeight{50 - _imageBorderY};
  *
  */
 
+extern std::string genStartString(const RenderContext & context);
+extern std::vector<std::string> genStartArgs(const RenderContext & context);
+extern Card::Container drawStandardPips(const RenderContext & context, bool rotate, size_t card, desc & pipD);
+extern Card::Container drawImage(const RenderContext & context, const desc & faceD, const std::string & fileName);
+extern bool parseCards(const std::string & filter, std::vector<std::string> & names);
+extern Deck layoutDeck(const RenderContext & context);
+extern void genRefreshScript(std::ostream & file, int argc, char *argv[]);
+extern std::vector<std::string> genCardArgs(const RenderContext & context, const Card & card);
+extern std::vector<const Card *> getLayers(const Deck & deck);
+extern int genOutputDirectory(const RenderContext & context, int argc, char *argv[], const std::string & command);
+extern int writeScript(std::ostream & file, const std::vector<RenderContext> & decks, int argc, char *argv[]);
 extern int generateScript(int argc, char *argv[]);
+extern int generateMakefile(int argc, char *argv[]);
+extern int renderCards(int argc, char *argv[]);
+extern int sweepCards(int argc, char *argv[]);
+extern int runJobs(int argc, char *argv[]);
 
 
 #endif //!defined _CARDGEN_H_INCLUDED_
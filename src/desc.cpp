@@ -23,13 +23,10 @@
  * Implementation for the info and desc classes.
  */
 
-#include <arpa/inet.h>
-#include <sstream>
-#include <fstream>
-
 #include "cardgen.h"
 #include "desc.h"
-#include "Configuration.h"
+#include "RenderContext.h"
+#include "Assets.h"
 
 
 /**
@@ -44,26 +41,7 @@ void info::print(std::ostream &os) const
 
 
 /**
- * Check validity of the .png file.
- *
- * @param  buffer - raw bytes of the image file.
- * @return true if valid, false otherwise.
- */
-bool desc::isValidPNG(const char * const buffer)
-{
-    const uint8_t magic[] = { 0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A };
-    for (int i{}; i < sizeof(magic); ++i)
-    {
-        if ((uint8_t)buffer[i] != magic[i])
-            return false;
-    }
-
-    return true;
-}
-
-
-/**
- * Read the size of the image in a png file and populate the class.
+ * Look up the size of the image in a png file and populate the class.
  *
  * @return error value or 0 if no errors.
  */
@@ -74,32 +52,18 @@ int desc::getImageSize(void)
     imageHeightPx = 1;
     aspectRatio = 1;
 
-//- Open the binary file.
-    std::ifstream file{fileName, std::ifstream::in|std::ifstream::binary};
-
-    if (!file.is_open())
+    if (!Assets::getImageSize(fileName, imageWidthPx, imageHeightPx))
         return 1;
 
-//- Success. Read header data.
-    char buffer[28]{};
-
-    file.read(buffer, 24);
-    if ((file) && (isValidPNG(buffer)))
-    {
-        fileFound = true;
-        imageWidthPx = htonl(*(uint32_t *)(buffer+16));
-        imageHeightPx = htonl(*(uint32_t *)(buffer+20));
-        aspectRatio = float(imageWidthPx) / imageHeightPx;
-    }
-
-    file.close();
+    fileFound = true;
+    aspectRatio = float(imageWidthPx) / imageHeightPx;
 
     return 0;
 }
 
 
 /**
- * Set up "drawString"" for drawing the .png file with the correct size and position.
+ * Set up "drawOp" for drawing the .png file with the correct size and position.
  *
  * @return error value or 0 if no errors.
  */
@@ -107,26 +71,20 @@ int desc::getImageSize(void)
 {
     if ((portHeightPx == 0) || (portWidthPx == 0))
     {
-        drawString = "";	// Don't draw anything here.
+        drawOp = Op{};	// Don't draw anything here.
+        wardOp = Op{};
 
         return 0;
     }
 
-    std::stringstream outputString{};
-    const auto cardWidthPx{Config::getCardWidthPx()};
-    const auto cardBorderPx{Config::getCardBorderPx()};
-
     int x{portOriginXPx + cardBorderPx};
     const int y{portOriginYPx + cardBorderPx};
     const int w{ROUND(portWidthPx)};
     const int h{ROUND(portHeightPx)};
-    outputString << "\t-draw \"image over " << x << ',' << y << ' ' << w << ',' << h << " '" << fileName << "'\" \\\n";
-    drawString = outputString.str();
+    drawOp = Op{x, y, w, h, fileName};
 
-    outputString.str(std::string());
     x = cardWidthPx - portOriginXPx - w + cardBorderPx;
-    outputString << "\t-draw \"image over " << x << ',' << y << ' ' << w << ',' << h << " '" << fileName << "'\" \\\n";
-    wardString = outputString.str();
+    wardOp = Op{x, y, w, h, fileName};
 
     return 0;
 }
@@ -135,18 +93,17 @@ int desc::getImageSize(void)
 /**
  * Constructor.
  *
+ * @param  context - context of the deck being laid out.
  * @param  H - Height of image as a percentage of card height.
  * @param  X - X value of centre of image as a percentage of card width.
  * @param  Y - Y value of centre of image as a percentage of card height.
  * @param  fileName - Name of image file.
  * @return true if valid, false otherwise.
  */
-desc::desc(float H, float X, float Y, const std::string & fileName)
-: fileName(fileName), fileFound(false)
+desc::desc(const RenderContext & context, float H, float X, float Y, const std::string & fileName)
+: fileName(fileName), fileFound(false),
+    cardWidthPx{context.getCardWidthPx()}, cardHeightPx{context.getCardHeightPx()}, cardBorderPx{context.getCardBorderPx()}
 {
-    const auto cardHeightPx{Config::getCardHeightPx()};
-    const auto cardWidthPx{Config::getCardWidthPx()};
-
     getImageSize();
     portHeightPx  = H * cardHeightPx / 100;
     portWidthPx   = portHeightPx * aspectRatio;
@@ -161,16 +118,15 @@ desc::desc(float H, float X, float Y, const std::string & fileName)
 /**
  * Constructor.
  *
+ * @param  context - context of the deck being laid out.
  * @param  I - Height and position of image as a percentage of card size.
  * @param  fileName - Name of image file.
  * @return true if valid, false otherwise.
  */
-desc::desc(const info & I, const std::string & fileName)
-: fileName(fileName), fileFound(false)
+desc::desc(const RenderContext & context, const info & I, const std::string & fileName)
+: fileName(fileName), fileFound(false),
+    cardWidthPx{context.getCardWidthPx()}, cardHeightPx{context.getCardHeightPx()}, cardBorderPx{context.getCardBorderPx()}
 {
-    const auto cardHeightPx{Config::getCardHeightPx()};
-    const auto cardWidthPx{Config::getCardWidthPx()};
-
     getImageSize();
     portHeightPx  = I.getH() * cardHeightPx / 100;
     portWidthPx   = portHeightPx * aspectRatio;
@@ -190,9 +146,6 @@ desc::desc(const info & I, const std::string & fileName)
  */
 void desc::reposition(float X, float Y)
 {
-    const auto cardHeightPx{Config::getCardHeightPx()};
-    const auto cardWidthPx{Config::getCardWidthPx()};
-
     portCentreXPx = X * cardWidthPx / 100;
     portCentreYPx = Y * cardHeightPx / 100;
     portOriginXPx = ROUND(centre2OriginX(portCentreXPx));
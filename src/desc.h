@@ -29,6 +29,10 @@
 #include <iostream>
 #include <string>
 
+#include "Card.h"
+
+class RenderContext;
+
 
 /**
  * @section info class.
@@ -47,7 +51,7 @@ private:
 
 public:
     info(float h, float x, float y) : H(h), X(x), Y(y), ChangedH{}, ChangedX{}, ChangedY{} {}
-    info(const info & a) : H(a.H), X(a.X), Y(a.Y), ChangedH{}, ChangedX{}, ChangedY{} {}
+    info(const info & a) : H(a.H), X(a.X), Y(a.Y), ChangedH{a.ChangedH}, ChangedX{a.ChangedX}, ChangedY{a.ChangedY} {}
 
     float getH(void) const { return H; }
     float getX(void) const { return X; }
@@ -81,12 +85,11 @@ protected:
 class desc
 {
 private:
-    bool isValidPNG(const char * const buffer);
     int getImageSize(void);
     int genDrawString(void);
 
-    std::string drawString;
-    std::string wardString;
+    Op drawOp;
+    Op wardOp;
     int imageWidthPx;
     int imageHeightPx;
     float aspectRatio;
@@ -101,9 +104,13 @@ private:
     std::string fileName;
     bool fileFound;
 
+    int cardWidthPx;
+    int cardHeightPx;
+    int cardBorderPx;
+
 public:
-    desc(float H, float X, float Y, const std::string & FN);
-    desc(const info & I, const std::string & FN);
+    desc(const RenderContext & context, float H, float X, float Y, const std::string & FN);
+    desc(const RenderContext & context, const info & I, const std::string & FN);
     void reposition(float X, float Y);
     void setFileName(const std::string & fileName);
     const std::string & getFileName(void) const { return fileName; }
@@ -118,7 +125,7 @@ public:
     float getAspectRatio(void) const { return aspectRatio; }
     int getPortOriginXPx(void) const { return portOriginXPx; }
     int getPortOriginYPx(void) const { return portOriginYPx; }
-    const std::string & draw(int left = true) const { return left ? drawString : wardString; }
+    const Op & draw(int left = true) const { return left ? drawOp : wardOp; }
 
     float centre2OriginX(float centre) const { return centre - (getPortWidthPx()/2); }
     float centre2OriginY(float centre) const { return centre - (getPortHeightPx()/2); }
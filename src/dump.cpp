@@ -28,11 +28,21 @@
 #include <sstream>
 #include <fstream>
 #include <vector>
+#include <map>
+#include <set>
+#include <algorithm>
+#include <filesystem>
+
+#include <sys/stat.h>
 
 #include "cardgen.h"
 #include "desc.h"
 #include "Loc.h"
 #include "Configuration.h"
+#include "RenderContext.h"
+#include "Cache.h"
+#include "Record.h"
+#include "Shard.h"
 
 
 /**
@@ -55,108 +65,197 @@ static const std::vector<const char*> cardNames{ "Joker", "Ace", "2", "3", "4",
 
 /**
  * Generate the initial blank card string used as a template for each card.
+ * This is generated once for each context.
  *
+ * @param  context - context of the deck being laid out.
  * @return the generated string.
  */
-static std::string genStartString(void)
+std::string genStartString(const RenderContext & context)
 {
-    static std::string outputString{};
-    if (outputString.empty())
-    {
-        std::stringstream stream{};
-        const auto cardWidthPx{Config::getCardWidthPx()};
-        const auto cardHeightPx{Config::getCardHeightPx()};
-        const auto cardBorderPx{Config::getCardBorderPx()};
-        const auto cardColour{Config::getCardColour()};
-        const auto mpc{Config::isMpc()};
-        const auto radius{Config::getRadius()};
-        const auto borderOffset{Config::getBorderOffset()};
-        const auto outlineWidth{Config::getOutlineWidth()};
-        const auto outlineHeight{Config::getOutlineHeight()};
-        const auto strokeWidth{Config::getStrokeWidth()};
-
-        stream  << "convert -size " << cardWidthPx + (2 * cardBorderPx) << "x" << cardHeightPx + (2 * cardBorderPx) << " xc:transparent  \\\n";
-        stream  << "\t-fill '" << cardColour << "' ";
-        if (mpc)
-            stream  << "-draw 'rectangle " << borderOffset << ',' << borderOffset << ' ' << outlineWidth + (2 * cardBorderPx) << ',' << outlineHeight + (2 * cardBorderPx) << "'";
-        else
-        if (radius)
-            stream  << "-stroke black -strokewidth " << strokeWidth << " -draw 'roundRectangle " << borderOffset << ',' << borderOffset << ' ' << outlineWidth << ',' << outlineHeight << ' ' << radius << ',' << radius << "'";
-        else
-            stream  << "-stroke black -strokewidth " << strokeWidth << " -draw 'rectangle " << borderOffset << ',' << borderOffset << ' ' << outlineWidth << ',' << outlineHeight << "'";
-        stream  << " \\\n";
+    std::stringstream stream{};
+    const auto cardWidthPx{context.getCardWidthPx()};
+    const auto cardHeightPx{context.getCardHeightPx()};
+    const auto cardBorderPx{context.getCardBorderPx()};
+    const auto cardColour{context.getCardColour()};
+    const auto mpc{context.isMpc()};
+    const auto radius{context.getRadius()};
+    const auto borderOffset{context.getBorderOffset()};
+    const auto outlineWidth{context.getOutlineWidth()};
+    const auto outlineHeight{context.getOutlineHeight()};
+    const auto strokeWidth{context.getStrokeWidth()};
+
+    stream  << _convertProgram << " -size " << cardWidthPx + (2 * cardBorderPx) << "x" << cardHeightPx + (2 * cardBorderPx) << " xc:transparent  \\\n";
+    stream  << "\t-fill '" << cardColour << "' ";
+    if (mpc)
+        stream  << "-draw 'rectangle " << borderOffset << ',' << borderOffset << ' ' << outlineWidth + (2 * cardBorderPx) << ',' << outlineHeight + (2 * cardBorderPx) << "'";
+    else
+    if (radius)
+        stream  << "-stroke black -strokewidth " << strokeWidth << " -draw 'roundRectangle " << borderOffset << ',' << borderOffset << ' ' << outlineWidth << ',' << outlineHeight << ' ' << radius << ',' << radius << "'";
+    else
+        stream  << "-stroke black -strokewidth " << strokeWidth << " -draw 'rectangle " << borderOffset << ',' << borderOffset << ' ' << outlineWidth << ',' << outlineHeight << "'";
+    stream  << " \\\n";
+
+    return stream.str();
+}
+
+/**
+ * Generate the 'convert' arguments for the initial blank card. This is the
+ * unquoted equivalent of genStartString().
+ *
+ * @param  context - context of the deck being laid out.
+ * @return the generated argument vector.
+ */
+std::vector<std::string> genStartArgs(const RenderContext & context)
+{
+    const auto cardWidthPx{context.getCardWidthPx()};
+    const auto cardHeightPx{context.getCardHeightPx()};
+    const auto cardBorderPx{context.getCardBorderPx()};
+    const auto mpc{context.isMpc()};
+    const auto radius{context.getRadius()};
+    const auto borderOffset{context.getBorderOffset()};
+    const auto outlineWidth{context.getOutlineWidth()};
+    const auto outlineHeight{context.getOutlineHeight()};
+    const auto strokeWidth{context.getStrokeWidth()};
+    const std::string origin{std::to_string(borderOffset) + ',' + std::to_string(borderOffset) + ' '};
+
+    std::vector<std::string> args{ _convertProgram, "-size",
+        std::to_string(cardWidthPx + (2 * cardBorderPx)) + "x" + std::to_string(cardHeightPx + (2 * cardBorderPx)),
+        "xc:transparent", "-fill", context.getCardColour() };
+
+    if (!mpc)
+        args.insert(args.end(), { "-stroke", "black", "-strokewidth", std::to_string(strokeWidth) });
+
+    args.push_back("-draw");
+    if (mpc)
+        args.push_back("rectangle " + origin + std::to_string(outlineWidth + (2 * cardBorderPx)) + ',' + std::to_string(outlineHeight + (2 * cardBorderPx)));
+    else
+    if (radius)
+        args.push_back("roundRectangle " + origin + std::to_string(outlineWidth) + ',' + std::to_string(outlineHeight) + ' ' + std::to_string(radius) + ',' + std::to_string(radius));
+    else
+        args.push_back("rectangle " + origin + std::to_string(outlineWidth) + ',' + std::to_string(outlineHeight));
+
+    return args;
+}
+
+/**
+ * Generate the complete 'convert' argument vector for a single card.
+ *
+ * @param  context - context of the deck being laid out.
+ * @param  card - card to generate the arguments for.
+ * @return the generated argument vector.
+ */
+std::vector<std::string> genCardArgs(const RenderContext & context, const Card & card)
+{
+    const Card * base{card.getBase()};
+    std::vector<std::string> args{};
+    if (base)
+        args = { _convertProgram, context.getOutputDirectory() + base->getName() + ".png" };
+    else
+        args = context.getStartArgs();
+
+    for (const auto & op : card)
+        op.addArgs(args);
+
+    if (!card.isLayer())
+        args.insert(args.end(), { "+dither", "-colors", "256" });
+    args.push_back(context.getOutputDirectory() + card.getName() + ".png");
+
+    return args;
+}
 
-        outputString = stream.str();
+/**
+ * Get the shared layers used by the cards in a deck, in the order they are
+ * first used.
+ *
+ * @param  deck - laid out deck.
+ * @return the layers.
+ */
+std::vector<const Card *> getLayers(const Deck & deck)
+{
+    std::vector<const Card *> layers{};
+    for (const auto & card : deck)
+    {
+        const Card * base{card.getBase()};
+        if ((base) && (std::find(layers.begin(), layers.end(), base) == layers.end()))
+            layers.push_back(base);
     }
 
-    return outputString;
+    return layers;
 }
 
 /**
- * Generate the final blank card string to end each card.
+ * Generate the final blank card string to end each card. Layers are not
+ * reduced to 256 colours as they are drawn on again.
  *
- * @return the generated string.
+ * @param  file - output stream.
+ * @param  context - context of the deck being laid out.
+ * @param  fileName - name of image file being generated.
+ * @param  layer - true if the image is a shared layer.
  */
-static void genEndString(std::ofstream & file, const std::string & fileName)
+static void genEndString(std::ostream & file, const RenderContext & context, const std::string & fileName, bool layer)
 {
-    file << "\t+dither -colors 256 \\\n";
-    file << "\t" << Config::getOutputDirectory() << fileName << ".png\n";
+    if (!layer)
+        file << "\t+dither -colors 256 \\\n";
+    file << "\t" << context.getOutputDirectory() << fileName << ".png\n";
     file << "\n";
 }
 
 /**
- * Generate the string for drawing the pips on the card. This is a two pass
- * process. The second pass is after the card image has been rotated.
+ * Generate the operations for drawing the pips on the card. This is a two
+ * pass process. The second pass is after the card image has been rotated.
  *
+ * @param  context - context of the deck being laid out.
  * @param  rotate - Rotated on first pass.
  * @param  card - 1 to 13 (ace to king).
  * @param  pipD - standard pip descriptor.
- * @return the generated string.
+ * @return the generated operations.
  */
-static std::string drawStandardPips(bool rotate, size_t card, desc & pipD)
+Card::Container drawStandardPips(const RenderContext & context, bool rotate, size_t card, desc & pipD)
 {
-    if (!PatternCollection::isIndex(card))
-        return "";
+    const PatternCollection & patterns{context.getPatterns()};
+    if (!patterns.isIndex(card))
+        return Card::Container{};
 
-    const float x{Config::getStandardPipX()};
-    const float y{Config::getStandardPipY()};
-    Pattern pattern{PatternCollection::getPattern(card)};
+    const float x{context.getStandardPipX()};
+    const float y{context.getStandardPipY()};
+    Pattern pattern{patterns.getPattern(card)};
     pattern.setRotate(rotate);
 
-    std::stringstream outputString{};
+    Card::Container ops{};
     for (auto [xOffset, yOffset] : pattern)
     {
         pipD.reposition(x + xOffset, y + yOffset);
-        outputString  << pipD.draw();
+        ops.push_back(pipD.draw());
     }
 
-    return outputString.str();
+    return ops;
 }
 
 
 /**
- * Generate the string for drawing the image on the card. Usually used for the
- * court cards. Numerous internal variables need to be recalculated if the
+ * Generate the operations for drawing the image on the card. Usually used for
+ * the court cards. Numerous internal variables need to be recalculated if the
  * aspect ratio of the image is to be maintained, otherwise the image is
  * stretched to fill the card. Note that this is done for each image because
  * the dimensions of the image can vary.
  *
+ * @param  context - context of the deck being laid out.
  * @param  faceD - Image descriptor.
  * @param  fileName - name of image file to use.
- * @return the generated string.
+ * @return the generated operations.
  */
-static std::string drawImage(const desc & faceD, const std::string & fileName)
+Card::Container drawImage(const RenderContext & context, const desc & faceD, const std::string & fileName)
 {
-    const auto cardWidthPx{Config::getCardWidthPx()};
-    const auto cardHeightPx{Config::getCardHeightPx()};
-    const auto cardBorderPx{Config::getCardBorderPx()};
-    const auto keepAspectRatio{Config::isKeepAspectRatio()};
-    const auto imageWidthPx{Config::getImageWidthPx()};
-    const auto imageHeightPx{Config::getImageHeightPx()};
-
-    std::stringstream outputString{};
-    int x{Config::getImageOffsetXPx() + cardBorderPx};
-    int y{Config::getImageOffsetYPx() + cardBorderPx};
+    const auto cardWidthPx{context.getCardWidthPx()};
+    const auto cardHeightPx{context.getCardHeightPx()};
+    const auto cardBorderPx{context.getCardBorderPx()};
+    const auto keepAspectRatio{context.isKeepAspectRatio()};
+    const auto imageWidthPx{context.getImageWidthPx()};
+    const auto imageHeightPx{context.getImageHeightPx()};
+
+    Card::Container ops{};
+    int x{context.getImageOffsetXPx() + cardBorderPx};
+    int y{context.getImageOffsetYPx() + cardBorderPx};
     int w{imageWidthPx};
     int h{imageHeightPx};
     float scale{1};
@@ -207,13 +306,13 @@ static std::string drawImage(const desc & faceD, const std::string & fileName)
         }
     }
 
-    outputString << "\t-draw \"image over " << x << ',' << y << ' ' << w << ',' << h << " '" << faceD.getFileName() << "'\" \\\n";
+    ops.emplace_back(x, y, w, h, faceD.getFileName());
 
 //- Check if image pips are required.
-    if ((!fileName.empty()) && (Config::getImagePipH()))
+    if ((!fileName.empty()) && (context.getImagePipH()))
     {
-        const auto imagePipScale{Config::getImagePipScale()};
-        const info & imagePipInfo{Config::getImagePipInfo()};
+        const auto imagePipScale{context.getImagePipScale()};
+        const info & imagePipInfo{context.getImagePipInfo()};
         info scaledPip{imagePipInfo};
 
         // Rescale image pips, but only if they haven't been manually altered.
@@ -227,7 +326,7 @@ static std::string drawImage(const desc & faceD, const std::string & fileName)
             scaledPip.setY(imagePipScale * imagePipInfo.getY());
 
         // Pip Filename is only supplied for court cards if they need pips adding.
-        desc pipD{scaledPip, fileName};
+        desc pipD{context, scaledPip, fileName};
         if (pipD.isFileFound())
         {
             const int x2{pipD.getPortOriginXPx()+x};
@@ -235,102 +334,94 @@ static std::string drawImage(const desc & faceD, const std::string & fileName)
             const int w2{ROUND(pipD.getPortWidthPx())};
             const int h2{ROUND(pipD.getPortHeightPx())};
 
-            outputString << "\t-draw \"image over " << x2 << ',' << y2 << ' ' << w2 << ',' << h2 << " '" << fileName << "'\" \\\n";
-            outputString << "\t-rotate 180 \\\n";
-            outputString << "\t-draw \"image over " << x2 << ',' << y2 << ' ' << w2 << ',' << h2 << " '" << fileName << "'\" \\\n";
-            outputString << "\t-rotate 180 \\\n";
+            ops.emplace_back(x2, y2, w2, h2, fileName);
+            ops.push_back(Op::rotate());
+            ops.emplace_back(x2, y2, w2, h2, fileName);
+            ops.push_back(Op::rotate());
         }
     }
 
-    return outputString.str();
+    return ops;
 }
 
 
 /**
  * ImageMagick Joker drawing routine.
  *
- * @param  file - output file stream.
- * @param  fileName - name of joker image file being generated.
+ * @param  context - joker context.
+ * @param  card - joker card being generated.
  */
-static void drawImageMagickJoker(std::ofstream & file, const std::string & fileName)
+static void drawImageMagickJoker(const RenderContext & context, Card & card)
 {
     const std::string faceFile{"boneyard/ImageMagick_logo.svg.png"};
-    const desc faceD{95, 50, 50, faceFile};
+    const desc faceD{context, 95, 50, 50, faceFile};
 
     const std::string headerFile{"boneyard/ImageMagickUsage.png"};
-    const desc headerD{4, 50, 10, headerFile};
+    const desc headerD{context, 4, 50, 10, headerFile};
     const std::string footerFile{"boneyard/ImageMagickURL.png"};
-    const desc footerD{3, 50, 90, footerFile};
+    const desc footerD{context, 3, 50, 90, footerFile};
 
-    file << genStartString();
-    file << drawImage(faceD, "");
-    file << headerD.draw();
-    file << footerD.draw();
-    genEndString(file, fileName);
+    card.add(drawImage(context, faceD, ""));
+    card.add(headerD.draw());
+    card.add(footerD.draw());
 }
 
 
 /**
  * Default Joker drawing routine.
  *
- * @param  file - output file stream.
- * @param  fileName - name of joker image file being generated.
+ * @param  context - joker context.
+ * @param  card - joker card being generated.
  * @param  indexD - joker index descriptor.
  */
-static void drawDefaultJoker(std::ofstream & file, const std::string & fileName, const desc & indexD)
+static void drawDefaultJoker(const RenderContext & context, Card & card, const desc & indexD)
 {
     const std::string faceFile{"boneyard/Back.png"};
-    const desc faceD(95, 50, 50, faceFile);
-
-    file << genStartString();
+    const desc faceD(context, 95, 50, 50, faceFile);
 
     // Draw "Joker" indices if provided.
     if (indexD.isFileFound())
     {
-        file << indexD.draw();
-        file << "\t-rotate 180 \\\n";
-        file << indexD.draw();
+        card.add(indexD.draw());
+        card.rotate();
+        card.add(indexD.draw());
     }
 
-    file << drawImage(faceD, "");
-    genEndString(file, fileName);
+    card.add(drawImage(context, faceD, ""));
 }
 
 
 /**
  * Joker drawing routine - a bit messy, but gets the job done.
  *
+ * @param  context - joker context.
  * @param  fails - default joker image output count.
- * @param  file - output file stream.
+ * @param  deck - deck to add the joker to.
  * @param  suit - index of suit for the joker being generated.
  * @return 0 if joker image found and used, 1 if default joker created.
  */
-static int drawJoker(int fails, std::ofstream & file, int suit)
+static int drawJoker(const RenderContext & context, int fails, Deck & deck, int suit)
 {
-    file << "# Draw the " << suitNames[suit] << " " << cardNames[0] << " as file " << suits[suit] << cardNames[0] << ".png\n";
-
     const std::string fileName{std::string(suits[suit]) + cardNames[0]};
-    const std::string faceFile{Config::getFaceDirectory() + fileName + ".png"};
-    const desc faceD{95, 50, 50, faceFile};
+    Card & card{deck.emplace_back(fileName, "Draw the " + std::string(suitNames[suit]) + " " + cardNames[0] + " as file " + fileName + ".png")};
+
+    const std::string faceFile{context.getFaceDirectory() + fileName + ".png"};
+    const desc faceD{context, 95, 50, 50, faceFile};
 
-    const std::string indexFile{Config::getIndexDirectory() + fileName + ".png"};
-    const desc indexD{Config::getIndexInfo(), indexFile};
+    const std::string indexFile{context.getIndexDirectory() + fileName + ".png"};
+    const desc indexD{context, context.getIndexInfo(), indexFile};
 
     if ((indexD.isFileFound()) || (faceD.isFileFound()))
     {
-        file << genStartString();
-
         if (indexD.isFileFound())
         {
-            file << indexD.draw();
-            file << "\t-rotate 180 \\\n";
-            file << indexD.draw();
+            card.add(indexD.draw());
+            card.rotate();
+            card.add(indexD.draw());
         }
 
         if (faceD.isFileFound())
-            file << drawImage(faceD, "");
-
-        genEndString(file, fileName);
+            card.add(drawImage(context, faceD, ""));
 
         return 0;
     }
@@ -340,11 +431,11 @@ static int drawJoker(int fails, std::ofstream & file, int suit)
     {
     case 0:
     case 2:
-        drawImageMagickJoker(file, fileName);
+        drawImageMagickJoker(context, card);
         break;
 
     default:
-        drawDefaultJoker(file, fileName, indexD);
+        drawDefaultJoker(context, card, indexD);
         break;
     }
 
@@ -353,74 +444,95 @@ static int drawJoker(int fails, std::ofstream & file, int suit)
 
 
 /**
- * The bulk of the script generation work.
+ * Parse the cards given to --cards, as groups separated by ';'. Each group
+ * is a suit, or '*' for every suit, and optionally ':' followed by a list
+ * of its cards separated by ',', or '*' for every card, or "jokers" for
+ * the jokers of every suit. For example "S:A,K;H:*;jokers".
  *
- * @param  argc - command line argument count.
- * @param  argv - command line argument vector.
- * @return error value or 0 if no errors.
+ * @param  filter - cards to parse.
+ * @param  names - set to the name of each card selected.
+ * @return true if the cards are valid, false otherwise.
  */
-int generateScript(int argc, char *argv[])
+bool parseCards(const std::string & filter, std::vector<std::string> & names)
 {
-    const auto scriptFilename{Config::getScriptFilename()};
-    const auto refreshFilename{Config::getRefreshFilename()};
-    const auto indexDirectory{Config::getIndexDirectory()};
-    const auto pipDirectory{Config::getPipDirectory()};
-    const auto faceDirectory{Config::getFaceDirectory()};
-    const auto outputDirectory{Config::getOutputDirectory()};
-    std::ofstream file{scriptFilename.c_str()};
-
-//- Open the script file for writing.
-    if (!file)
+    names.clear();
+    std::istringstream groups{filter};
+    std::string group{};
+    while (std::getline(groups, group, ';'))
     {
-        std::cerr << "Can't open output file " << scriptFilename << " - aborting!\n";
+        if (group.empty())
+            continue;
 
-        return 1;
-    }
+        if (group == "jokers")
+            group = "*:Joker";
 
-//- Generate the initial preamble of the script.
-    file << "#!/bin/sh\n";
-    file << "\n";
-    file << "# This file was generated as \"" << scriptFilename << "\" using the following command:\n";
-    file << "#\n";
-    file << "#  ";
-    for (int i = 0; i < argc; ++i)
-        file << argv[i] << ' ';
+        const auto colon{group.find(':')};
+        const std::string suit{group.substr(0, colon)};
+        const std::string list{(colon == std::string::npos) ? "*" : group.substr(colon + 1)};
+        std::vector<bool> selected(suits.size());
+        for (size_t s{}; s < suits.size(); ++s)
+            selected[s] = (suit == "*") || (suit == suits[s]);
 
-    file << "\n";
-    file << "#\n";
-    file << "\n";
-    file << "# Make the directories."  << "\n";
-    file << "mkdir -p " << _outputBase << "\n";
-    file << "mkdir -p " << outputDirectory.substr(0, outputDirectory.length()-1) << "\n";
+        if (std::find(selected.begin(), selected.end(), true) == selected.end())
+            return false;
 
-    file << "\n";
-    file << "# Generate the refresh script." << "\n";
-    file << "cat <<EOM >" << outputDirectory << refreshFilename << "\n";
-    file << "#!/bin/sh\n";
-    file << "\n";
-    file << "# This file was generated using the following " << argv[0] << " command.\n";
-    file << "#\n";
-    file << "cd ../../\n";
-    for (int i = 0; i < argc; ++i)
-        file << argv[i] << ' ';
+        std::istringstream stream{list};
+        std::string card{};
+        while (std::getline(stream, card, ','))
+        {
+            std::vector<size_t> ranks{};
+            if (card == "*")
+                for (size_t c{1}; c < cards.size(); ++c)
+                    ranks.push_back(c);
+            else
+            if (card == cardNames[0])
+                ranks.push_back(0);
+            else
+            {
+                const auto it{std::find(cards.begin() + 1, cards.end(), card)};
+                if (it == cards.end())
+                    return false;
 
-    file << "\n";
-    file << "./" << scriptFilename << "\n";
-    file << "EOM\n";
-    file << "\n";
-    file << "chmod +x " << outputDirectory << refreshFilename << "\n";
-    file << "\n";
+                ranks.push_back(size_t(it - cards.begin()));
+            }
 
+            for (const auto c : ranks)
+                for (size_t s{}; s < suits.size(); ++s)
+                    if (selected[s])
+                        names.push_back(std::string(suits[s]) + (c ? cards[c] : cardNames[0]));
+        }
+    }
 
-//- Initial blank card string used as a template for each card.
-    const std::string startString{genStartString()};
-    const auto indexInfo{Config::getIndexInfo()};
-    const auto cornerPipInfo{Config::getCornerPipInfo()};
-    const auto standardPipInfo{Config::getStandardPipInfo()};
-    const auto imageHeight{Config::getImageHeight()};
-    const auto imageX{Config::getImageX()};
-    const auto imageY{Config::getImageY()};
-    const auto quad{Config::isQuad()};
+    return !names.empty();
+}
+
+
+/**
+ * Lay out every card in the deck, or those selected with --cards, as a
+ * sequence of drawing operations.
+ *
+ * @param  context - context of the deck.
+ * @return the laid out deck.
+ */
+Deck layoutDeck(const RenderContext & context)
+{
+    const auto indexDirectory{context.getIndexDirectory()};
+    const auto pipDirectory{context.getPipDirectory()};
+    const auto faceDirectory{context.getFaceDirectory()};
+
+    const auto & indexInfo{context.getIndexInfo()};
+    const auto & cornerPipInfo{context.getCornerPipInfo()};
+    const auto & standardPipInfo{context.getStandardPipInfo()};
+    const auto imageHeight{context.getImageHeight()};
+    const auto imageX{context.getImageX()};
+    const auto imageY{context.getImageY()};
+    const auto quad{context.isQuad()};
+    const auto layers{context.isLayers()};
+    const auto mirror{context.isMirror()};
+    const auto cardWidthPx{context.getCardWidthPx() + (2 * context.getCardBorderPx())};
+    const auto cardHeightPx{context.getCardHeightPx() + (2 * context.getCardBorderPx())};
+
+    Deck deck{};
 
 //- Generate all the playing cards.
     for (size_t s = 0; s < suits.size(); ++s)
@@ -428,7 +540,7 @@ int generateScript(int argc, char *argv[])
         const std::string suit{std::string(suits[s])};
 
         std::string pipFile{pipDirectory + suit + "S.png"};     // Try small pip file first.
-        desc pipD{cornerPipInfo, pipFile};
+        desc pipD{context, cornerPipInfo, pipFile};
         if (!pipD.isFileFound())
         {
             // Small pip file not found, so use standard pip file.
@@ -436,17 +548,42 @@ int generateScript(int argc, char *argv[])
             pipD.setFileName(pipFile);
         }
 
+        // The blank card and the corner pips are the same for every card in
+        // the suit and are unchanged by rotation, so draw them once as a
+        // shared layer if requested. Each shard draws its own layers, as
+        // they are removed once its cards are drawn.
+        std::shared_ptr<Card> layer{};
+        if (layers)
+        {
+            const std::string layerName{"." + suit + context.getShardSuffix()};
+            layer = std::make_shared<Card>(layerName, "Draw the corner pips of " + std::string(suitNames[s]) + " as file " + layerName + ".png.", true);
+            for (int pass = 0; pass < 2; ++pass)
+            {
+                if (pass)
+                    layer->rotate();
+
+                layer->add(pipD.draw());
+                if (quad)
+                    layer->add(pipD.draw(false));
+            }
+
+            if (mirror)
+                layer->mirror(cardWidthPx, cardHeightPx);
+        }
+
         // Generate the playing cards in the current suit.
         pipFile = pipDirectory + suit + ".png";             // Use standard pip file.
-        desc standardPipD{standardPipInfo, pipFile};
+        desc standardPipD{context, standardPipInfo, pipFile};
         for (size_t c = 1; c < cards.size(); ++c)
         {
             // Set up the variables.
             std::string card{std::string(cards[c])};
             std::string fileName{suit + card};
+            if (!context.isSelected(fileName))
+                continue;
 
             std::string indexFile{indexDirectory + fileName + ".png"};
-            desc indexD{indexInfo, indexFile};
+            desc indexD{context, indexInfo, indexFile};
             if (!indexD.isFileFound())
             {
                 // indexInfo for suit file not found, so use alternate index file.
@@ -455,70 +592,664 @@ int generateScript(int argc, char *argv[])
             }
 
             std::string faceFile{faceDirectory + fileName + ".png"};
-            desc faceD{imageHeight, imageX, imageY, faceFile};
+            desc faceD{context, imageHeight, imageX, imageY, faceFile};
 
-            std::string drawFace{};
+            Card::Container drawFace{};
 
             if (faceD.useStandardPips())
             {
                 // The face directory does not have the needed image file, use standard pips.
-                drawFace = drawStandardPips(true, c, standardPipD);
+                drawFace = drawStandardPips(context, true, c, standardPipD);
             }
             else
             {
                 // The face directory has the needed image file, so use it.
                 // Note, we only pass the pipfile name for the court cards (c > 10).
-                drawFace = drawImage(faceD, c > 10 ? pipFile : "");
+                drawFace = drawImage(context, faceD, c > 10 ? pipFile : "");
             }
 
 
-            // Write to output file.
-            file << "# Draw the " << cardNames[c] << " of " << suitNames[s] << " as file " << fileName << ".png.\n";
-            file << startString;
+            // Add to the deck.
+            Card & output{deck.emplace_back(fileName, "Draw the " + std::string(cardNames[c]) + " of " + suitNames[s] + " as file " + fileName + ".png.")};
+
+            if (layer)
+                output.setBase(layer);
 
             if ((faceD.useStandardPips()) || (faceD.isFileFound() && faceD.isLandscape()))
-                file << drawFace;			// Draw either half of the pips or one of the landscape images.
+                output.add(drawFace);           // Draw either half of the pips or one of the landscape images.
 
-            file << pipD.draw();            // Draw corner pip.
-            file << indexD.draw();          // Draw index.
+            if (!layer)
+                output.add(pipD.draw());        // Draw corner pip.
+            output.add(indexD.draw());          // Draw index.
             if (quad)
             {
-                file << pipD.draw(false);   // Draw right-hand corner pip.
-                file << indexD.draw(false); // Draw right-hand index.
+                if (!layer)
+                    output.add(pipD.draw(false));   // Draw right-hand corner pip.
+                output.add(indexD.draw(false)); // Draw right-hand index.
             }
 
-            file << "\t-rotate 180 \\\n";
+            output.rotate();
 
             if (faceD.useStandardPips())
-                drawFace = drawStandardPips(false, c, standardPipD);
+                drawFace = drawStandardPips(context, false, c, standardPipD);
 
-            file << drawFace;				// Draw either the rest of the pips or the needed image.
-            file << pipD.draw();            // Draw corner pip.
-            file << indexD.draw();          // Draw index.
+            output.add(drawFace);               // Draw either the rest of the pips or the needed image.
+            if (!layer)
+                output.add(pipD.draw());        // Draw corner pip.
+            output.add(indexD.draw());          // Draw index.
             if (quad)
             {
-                file << pipD.draw(false);   // Draw right-hand corner pip.
-                file << indexD.draw(false); // Draw right-hand index.
+                if (!layer)
+                    output.add(pipD.draw(false));   // Draw right-hand corner pip.
+                output.add(indexD.draw(false)); // Draw right-hand index.
             }
-
-            genEndString(file, fileName);
         }
     }
 
 
 //- Add the Jokers using narrower borders.
-    Config::setImageBorderX(7);
-    Config::setImageBorderY(5);
-    Config::getIndexInfo().setH(30.0);
-    Config::getIndexInfo().setY(20.0);
-    Config::instance().recalculate();
+    const RenderContext jokerContext{context.getJokerContext()};
 
+    // Every joker is laid out, as the ones without an image are drawn in
+    // turn in each of the default styles, then the unselected are dropped.
     int fails{};
     for (int s = 0; s < suits.size(); ++s)
-        fails += drawJoker(fails, file, s);
+    {
+        fails += drawJoker(jokerContext, fails, deck, s);
+        if (!context.isSelected(deck.back().getName()))
+            deck.pop_back();
+    }
+
+    if (mirror)
+        for (auto & card : deck)
+            card.mirror(cardWidthPx, cardHeightPx);
+
+    return deck;
+}
+
+
+/**
+ * Quote an argument for the shell if it holds any characters that the
+ * shell would act on, such as the ';' and '*' of --cards.
+ *
+ * @param  arg - argument to quote.
+ * @return the quoted argument.
+ */
+static std::string shellQuote(const std::string & arg)
+{
+    if ((!arg.empty()) && (arg.find_first_not_of("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_-+=/.,:%@") == std::string::npos))
+        return arg;
+
+    std::string output{"'"};
+    for (const char c : arg)
+        output += (c == '\'') ? std::string{"'\\''"} : std::string(1, c);
+
+    return output + "'";
+}
+
+
+/**
+ * Generate the refresh script that re-runs the command that generated the
+ * cards. It is stored with the output so the cards can be regenerated.
+ *
+ * @param  file - output stream.
+ * @param  argc - command line argument count.
+ * @param  argv - command line argument vector.
+ */
+void genRefreshScript(std::ostream & file, int argc, char *argv[])
+{
+    file << "#!/bin/sh\n";
+    file << "\n";
+    file << "# This file was generated using the following " << argv[0] << " command.\n";
+    file << "#\n";
+    file << "cd ../../\n";
+    if (Shard::isEnabled())
+        file << "# It draws shard " << Config::getShard() << " of " << Config::getShards() << ", the other shards are drawn by the same command with each --shard i/" << Config::getShards() << ".\n";
+    for (int i = 0; i < argc; ++i)
+        file << shellQuote(argv[i]) << ' ';
+
+    file << "\n";
+}
+
+
+/**
+ * Make the output directories and write the refresh script directly, for the
+ * output modes that don't generate a shell script to do it.
+ *
+ * @param  context - context of the deck.
+ * @param  argc - command line argument count.
+ * @param  argv - command line argument vector.
+ * @param  command - command the refresh script runs after cardgen, if any.
+ * @return error value or 0 if no errors.
+ */
+int genOutputDirectory(const RenderContext & context, int argc, char *argv[], const std::string & command)
+{
+    const auto refreshFilename{Config::getRefreshFilename()};
+    const auto outputDirectory{context.getOutputDirectory()};
+
+    std::error_code ec{};
+    std::filesystem::create_directories(outputDirectory, ec);
+    if (ec)
+    {
+        std::cerr << "Can't create output directory " << outputDirectory << " - aborting!\n";
+
+        return 1;
+    }
+
+    const std::string refreshFile{outputDirectory + refreshFilename};
+    std::ofstream file{refreshFile.c_str()};
+    if (!file)
+    {
+        std::cerr << "Can't open output file " << refreshFile << " - aborting!\n";
+
+        return 1;
+    }
+
+    genRefreshScript(file, argc, argv);
+    if (!command.empty())
+        file << command << "\n";
+    file.close();
+
+    chmod(refreshFile.c_str(), S_IRWXU|S_IRGRP|S_IXGRP|S_IROTH|S_IXOTH);
+
+    return 0;
+}
+
+
+/**
+ * Generate the 'convert' command for a single card.
+ *
+ * @param  file - output stream.
+ * @param  context - context of the deck.
+ * @param  card - card to generate the command for.
+ */
+static void genCardString(std::ostream & file, const RenderContext & context, const Card & card)
+{
+    const Card * base{card.getBase()};
+    if (base)
+        file << _convertProgram << " " << context.getOutputDirectory() << base->getName() << ".png \\\n";
+    else
+        file << context.getStartString();
+
+    for (const auto & op : card)
+        file << op;
+    genEndString(file, context, card.getName(), card.isLayer());
+}
+
+
+/**
+ * Write the 'convert' command for a single card to the script.
+ *
+ * @param  file - output stream.
+ * @param  context - context of the deck.
+ * @param  card - card to write.
+ */
+static void writeCard(std::ostream & file, const RenderContext & context, const Card & card)
+{
+    file << "# " << card.getComment() << "\n";
+    genCardString(file, context, card);
+}
+
+
+/**
+ * Write a single 'convert' command that draws every card, for use when the
+ * process start up and decoding of the component images would dominate.
+ * The blank card, each component image and each shared layer is decoded or
+ * drawn once into a memory register and cloned from there for each card.
+ * Images drawn rotated are rotated once into a register of their own.
+ * The image list is empty between cards, so no parentheses are needed.
+ *
+ * @param  file - output stream.
+ * @param  context - context of the deck.
+ * @param  deck - laid out deck.
+ */
+static void writeMprCards(std::ostream & file, const RenderContext & context, const Deck & deck)
+{
+    const auto outputDirectory{context.getOutputDirectory()};
+    const auto layers{getLayers(deck)};
+
+    std::vector<const Card *> cards{layers};
+    for (const auto & card : deck)
+        cards.push_back(&card);
+
+    file << "# Draw all the cards in a single process, decoding each image only once.\n";
+    file << context.getStartString();
+    file << "\t-write mpr:blank +delete \\\n";
+
+    std::map<std::string, std::string> registers{};
+    std::map<std::string, std::string> rotatedRegisters{};
+    for (const auto card : cards)
+    {
+        for (const auto & op : *card)
+        {
+            auto & table{op.isRotated() ? rotatedRegisters : registers};
+            if ((op.isImage()) && (!table.count(op.getFileName())))
+            {
+                const std::string name{"mpr:" + std::string(op.isRotated() ? "r" : "i") + std::to_string(table.size())};
+                table[op.getFileName()] = name;
+                file << "\t'" << op.getFileName() << "' " << (op.isRotated() ? "-rotate 180 " : "") << "-write " << name << " +delete \\\n";
+            }
+        }
+    }
+
+    for (const auto card : cards)
+    {
+        file << "\tmpr:" << (card->getBase() ? card->getBase()->getName() : "blank") << " \\\n";
+        for (const auto & op : *card)
+        {
+            if (op.isImage())
+                file << Op{op.getX(), op.getY(), op.getW(), op.getH(), (op.isRotated() ? rotatedRegisters : registers)[op.getFileName()]};
+            else
+                file << op;
+        }
+
+        if (card->isLayer())
+            file << "\t-write mpr:" << card->getName() << " +delete \\\n";
+        else
+            file << "\t+dither -colors 256 -write " << outputDirectory << card->getName() << ".png +delete \\\n";
+    }
+
+    file << "\tnull:\n";
+    file << "\n";
+}
+
+
+/**
+ * Remove the cards that are unchanged since they were last drawn from a
+ * laid out deck. The remaining cards are removed from the record of the
+ * deck, and the script adds each back once it has been drawn.
+ *
+ * @param  context - context of the deck.
+ * @param  deck - laid out deck, set to the cards that have changed.
+ * @param  keys - set to the key of each card that has changed.
+ * @return error value or 0 if no errors.
+ */
+static int selectChanged(const RenderContext & context, Deck & deck, std::vector<std::string> & keys)
+{
+    const auto outputDirectory{context.getOutputDirectory()};
+    Record record{outputDirectory};
+    Deck changed{};
+    for (const auto & card : deck)
+    {
+        const std::string key{Cache::getKey(context, card, "convert")};
+        if (record.check(card.getName(), key, outputDirectory + card.getName() + ".png"))
+            continue;
+
+        record.erase(card.getName());
+        changed.push_back(card);
+        keys.push_back(key);
+    }
+    deck = std::move(changed);
+
+    return record.save();
+}
+
+
+/**
+ * Write the part of the script that draws a single deck.
+ *
+ * @param  file - output stream.
+ * @param  context - context of the deck.
+ * @param  deck - laid out deck, or the cards of it in this shard.
+ * @param  argc - command line argument count.
+ * @param  argv - command line argument vector.
+ * @return error value or 0 if no errors.
+ */
+static int writeDeck(std::ostream & file, const RenderContext & context, Deck deck, int argc, char *argv[])
+{
+    const auto scriptFilename{Config::getScriptFilename()};
+    const auto refreshFilename{Config::getRefreshFilename()};
+    const auto outputDirectory{context.getOutputDirectory()};
+
+    file << "# Make the directories."  << "\n";
+    file << "mkdir -p " << _outputBase << "\n";
+    file << "mkdir -p " << outputDirectory.substr(0, outputDirectory.length()-1) << "\n";
+
+    file << "\n";
+    file << "# Generate the refresh script." << "\n";
+    file << "cat <<EOM >" << outputDirectory << refreshFilename << "\n";
+    genRefreshScript(file, argc, argv);
+    file << "./" << scriptFilename << "\n";
+    file << "EOM\n";
+    file << "\n";
+    file << "chmod +x " << outputDirectory << refreshFilename << "\n";
+    file << "\n";
+
+
+//- Generate the shared layers, then all the playing cards.
+    std::vector<std::string> keys{};
+    const std::string recordFile{outputDirectory + _recordFilename};
+    if (deck.empty())
+    {
+        file << "echo No cards of this shard in " << outputDirectory << "\n";
+        file << "\n";
+
+        return 0;
+    }
+
+    if (Record::isIncremental())
+    {
+        if (selectChanged(context, deck, keys))
+            return 1;
+
+        if (deck.empty())
+        {
+            file << "echo No cards changed in " << outputDirectory << "\n";
+            file << "\n";
+
+            return 0;
+        }
+    }
+
+    if (Config::isMpr())
+    {
+        writeMprCards(file, context, deck);
+        if (!keys.empty())
+        {
+            file << "[ $? -eq 0 ] && cat <<EOM >>" << recordFile << "\n";
+            for (size_t i{}; i < deck.size(); ++i)
+                file << keys[i] << " " << deck[i].getName() << "\n";
+            file << "EOM\n";
+            file << "\n";
+        }
+        file << "echo Output created in " << outputDirectory << "\n";
+        file << "\n";
+
+        return 0;
+    }
+
+    const auto layers{getLayers(deck)};
+    for (const auto layer : layers)
+        writeCard(file, context, *layer);
+
+    for (size_t i{}; i < deck.size(); ++i)
+    {
+        writeCard(file, context, deck[i]);
+        if (!keys.empty())
+        {
+            file << "[ $? -eq 0 ] && echo " << keys[i] << " " << deck[i].getName() << " >>" << recordFile << "\n";
+            file << "\n";
+        }
+    }
+
+    if (!layers.empty())
+    {
+        file << "# Remove the shared layers.\n";
+        file << "rm -f";
+        for (const auto layer : layers)
+            file << " " << outputDirectory << layer->getName() << ".png";
+        file << "\n";
+        file << "\n";
+    }
 
     file << "echo Output created in " << outputDirectory << "\n";
     file << "\n";
 
     return 0;
 }
+
+
+/**
+ * The bulk of the script generation work.
+ *
+ * @param  file - output stream.
+ * @param  decks - context of each deck.
+ * @param  argc - command line argument count.
+ * @param  argv - command line argument vector.
+ * @return error value or 0 if no errors.
+ */
+int writeScript(std::ostream & file, const std::vector<RenderContext> & decks, int argc, char *argv[])
+{
+    const auto scriptFilename{Config::getScriptFilename()};
+
+//- Generate the initial preamble of the script.
+    file << "#!/bin/sh\n";
+    file << "\n";
+    file << "# This file was generated as \"" << scriptFilename << "\" using the following command:\n";
+    file << "#\n";
+    file << "#  ";
+    for (int i = 0; i < argc; ++i)
+        file << argv[i] << ' ';
+
+    file << "\n";
+    file << "#\n";
+    file << "\n";
+
+//- Lay out every deck and keep the cards of this shard.
+    std::vector<Deck> layouts{};
+    for (const auto & context : decks)
+        layouts.push_back(layoutDeck(context));
+    Shard::select(layouts);
+
+//- Generate each deck in turn.
+    for (size_t i{}; i < decks.size(); ++i)
+        if (writeDeck(file, decks[i], std::move(layouts[i]), argc, argv))
+            return 1;
+
+    return 0;
+}
+
+
+/**
+ * Generate the script file.
+ *
+ * @param  argc - command line argument count.
+ * @param  argv - command line argument vector.
+ * @return error value or 0 if no errors.
+ */
+int generateScript(int argc, char *argv[])
+{
+    std::vector<RenderContext> decks{};
+    if (Config::getDecks(argc, argv, decks))
+        return 1;
+
+    const auto scriptFilename{Config::getScriptFilename()};
+    std::ofstream file{scriptFilename.c_str()};
+
+//- Open the script file for writing.
+    if (!file)
+    {
+        std::cerr << "Can't open output file " << scriptFilename << " - aborting!\n";
+
+        return 1;
+    }
+
+    return writeScript(file, decks, argc, argv);
+}
+
+
+/**
+ * Escape a string for use in a Makefile. Only '$' is special in recipes,
+ * targets and prerequisites also need spaces, colons and hashes escaping.
+ *
+ * @param  value - string to escape.
+ * @param  target - true if the string is a target or prerequisite.
+ * @return the escaped string.
+ */
+static std::string makeEscape(const std::string & value, bool target)
+{
+    std::string output{};
+    for (const char c : value)
+    {
+        if (c == '$')
+            output += '$';
+        else
+        if ((target) && ((c == ' ') || (c == ':') || (c == '#')))
+            output += '\\';
+
+        output += c;
+    }
+
+    return output;
+}
+
+
+/**
+ * Write a file, but only if its contents have changed, so that its
+ * modification time can be used as a 'make' prerequisite.
+ *
+ * @param  fileName - name of file to write.
+ * @param  contents - new contents of the file.
+ * @return error value or 0 if no errors.
+ */
+static int updateFile(const std::string & fileName, const std::string & contents)
+{
+    {
+        std::ifstream file{fileName, std::ifstream::in|std::ifstream::binary};
+        if (file)
+        {
+            std::stringstream current{};
+            current << file.rdbuf();
+            if (current.str() == contents)
+                return 0;
+        }
+    }
+
+    std::ofstream file{fileName, std::ofstream::out|std::ofstream::binary};
+    if (!file)
+    {
+        std::cerr << "Can't open output file " << fileName << " - aborting!\n";
+
+        return 1;
+    }
+
+    file << contents;
+
+    return 0;
+}
+
+
+/**
+ * Generate a Makefile with one target per card, each depending on the
+ * component images it uses and on a command file that is only rewritten when
+ * the card's 'convert' command changes. Running "make -j" then draws the
+ * cards in parallel and only redraws the cards whose inputs have changed.
+ *
+ * @param  argc - command line argument count.
+ * @param  argv - command line argument vector.
+ * @return error value or 0 if no errors.
+ */
+int generateMakefile(int argc, char *argv[])
+{
+    std::vector<RenderContext> contexts{};
+    if (Config::getDecks(argc, argv, contexts))
+        return 1;
+
+    const auto makeFilename{Config::getMakeFilename()};
+    const std::string command{"make -f " + makeFilename + " -j$(nproc)"};
+
+//- Make the directories and generate the refresh scripts.
+    for (const auto & context : contexts)
+        if (genOutputDirectory(context, argc, argv, command))
+            return 1;
+
+//- Lay out the cards and write the command file for each card.
+    std::set<std::string> directories{};
+    std::vector<std::string> cards{};
+    std::vector<std::string> intermediates{};
+    std::stringstream rules{};
+    for (const auto & context : contexts)
+    {
+        const auto outputDirectory{context.getOutputDirectory()};
+        const Deck deck{layoutDeck(context)};
+
+        directories.insert({
+            context.getIndexDirectory(),
+            context.getPipDirectory(),
+            context.getFaceDirectory() });
+
+        const auto layers{getLayers(deck)};
+        std::vector<const Card *> targets{layers};
+        for (const auto & card : deck)
+        {
+            targets.push_back(&card);
+            cards.push_back(outputDirectory + card.getName() + ".png");
+        }
+
+        for (const auto layer : layers)
+            intermediates.push_back(outputDirectory + layer->getName() + ".png");
+
+        for (const auto target : targets)
+        {
+            const Card & card{*target};
+            const std::string outputFile{outputDirectory + card.getName() + ".png"};
+            const std::string cmdFile{outputDirectory + "." + card.getName() + ".cmd"};
+
+            std::stringstream recipe{};
+            genCardString(recipe, context, card);
+            if (updateFile(cmdFile, recipe.str()))
+                return 1;
+
+            rules << "# " << card.getComment() << "\n";
+            rules << makeEscape(outputFile, true) << ": " << makeEscape(cmdFile, true);
+            if (card.getBase())
+                rules << " " << makeEscape(outputDirectory + card.getBase()->getName() + ".png", true);
+
+            std::set<std::string> files{};
+            for (const auto & op : card)
+            {
+                if ((op.isImage()) && (files.insert(op.getFileName()).second))
+                {
+                    rules << " " << makeEscape(op.getFileName(), true);
+                    directories.insert(std::filesystem::path{op.getFileName()}.parent_path().string() + "/");
+                }
+            }
+            rules << "\n\t" << makeEscape(recipe.str(), false);
+        }
+    }
+
+//- Open the Makefile for writing.
+    std::ofstream file{makeFilename.c_str()};
+    if (!file)
+    {
+        std::cerr << "Can't open output file " << makeFilename << " - aborting!\n";
+
+        return 1;
+    }
+
+//- Generate the initial preamble of the Makefile.
+    file << "# This file was generated as \"" << makeFilename << "\" using the following command:\n";
+    file << "#\n";
+    file << "#  ";
+    for (int i = 0; i < argc; ++i)
+        file << makeEscape(shellQuote(argv[i]), false) << ' ';
+
+    file << "\n";
+    file << "#\n";
+    file << "# Draw the cards in parallel using: " << command << "\n";
+    file << "\n";
+    file << "CARDS = \\\n";
+    for (const auto & card : cards)
+        file << "\t" << makeEscape(card, true) << " \\\n";
+    file << "\n";
+    file << "all: $(CARDS)\n";
+    for (const auto & context : contexts)
+        file << "\t@echo Output created in " << makeEscape(context.getOutputDirectory(), false) << "\n";
+    file << "\n";
+    file << ".PHONY: all\n";
+    if (!intermediates.empty())
+    {
+        file << ".INTERMEDIATE:";
+        for (const auto & intermediate : intermediates)
+            file << " " << makeEscape(intermediate, true);
+        file << "\n";
+    }
+    file << "\n";
+
+    file << "# Regenerate this file if component images are added or removed.\n";
+    file << makeEscape(makeFilename, true) << ":";
+    for (const auto & directory : directories)
+        file << " " << makeEscape(directory.substr(0, directory.length()-1), true);
+    if (Config::isBatch())
+        file << " " << makeEscape(Config::getBatchFilename(), true);
+    file << "\n\t";
+    for (int i = 0; i < argc; ++i)
+        file << makeEscape(shellQuote(argv[i]), false) << ' ';
+    file << "\n";
+    file << "\n";
+
+//- Add the rule for each card.
+    file << rules.str();
+
+    return 0;
+}
@@ -0,0 +1,416 @@
+/**
+ * @file    jobs.cpp
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'cardgen' is a playing card image generator.
+ *
+ * Parallel job runner that executes the per-card 'convert' commands itself.
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <filesystem>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "cardgen.h"
+#include "Cache.h"
+#include "Record.h"
+#include "PngWriter.h"
+#include "Shard.h"
+#include "Configuration.h"
+#include "RenderContext.h"
+
+extern char **environ;
+
+
+/**
+ * @section Job class.
+ *
+ * Used to track a single 'convert' process and the errors it reports. The
+ * process writes the image under a temporary name, which is renamed to the
+ * output file once the process succeeds.
+ */
+class Job
+{
+private:
+    const Card * card;
+    std::vector<std::string> args;
+    std::string outputFile;
+    std::string key;
+    Record * record;
+    int attempts;
+    pid_t pid;
+    int fd;
+    int status;
+    std::string errors;
+
+public:
+    Job(const RenderContext & context, const Card & c, const std::string & k, Record * r=nullptr);
+
+    bool start(void);
+    bool read(void);
+    bool wait(void);
+    bool commit(void);
+
+    const Card & getCard(void) const { return *card; }
+    const std::string & getKey(void) const { return key; }
+    Record * getRecord(void) const { return record; }
+    const std::string & getOutputFilename(void) const { return outputFile; }
+    int getAttempts(void) const { return attempts; }
+    int getFd(void) const { return fd; }
+    bool isSuccess(void) const { return WIFEXITED(status) && (WEXITSTATUS(status) == 0); }
+    const std::string & getErrors(void) const { return errors; }
+    std::string getStatusString(void) const;
+
+};
+
+
+/**
+ * Constructor. Generate the 'convert' arguments of a card, writing the image
+ * under its temporary name.
+ *
+ * @param  context - context of the deck.
+ * @param  c - card to draw.
+ * @param  k - key of the card, or empty if it isn't cached or recorded.
+ * @param  r - record of the deck, or nullptr if the card isn't recorded.
+ */
+Job::Job(const RenderContext & context, const Card & c, const std::string & k, Record * r) :
+    card{&c}, args{genCardArgs(context, c)}, outputFile{args.back()}, key{k}, record{r},
+    attempts{}, pid{-1}, fd{-1}, status{}, errors{}
+{
+    args.back() = "png:" + PngWriter::getTempFilename(outputFile);
+}
+
+/**
+ * Start the 'convert' process with its standard error connected to a pipe.
+ *
+ * @return true if the process was started, false otherwise.
+ */
+bool Job::start(void)
+{
+    ++attempts;
+    errors.clear();
+    status = 0;
+
+    int fds[2]{};
+    if (pipe2(fds, O_CLOEXEC))
+    {
+        errors = "Can't create pipe.\n";
+        status = W_EXITCODE(127, 0);
+
+        return false;
+    }
+
+    posix_spawn_file_actions_t actions{};
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], STDERR_FILENO);
+
+    std::vector<char *> argv{};
+    for (auto & arg : args)
+        argv.push_back(arg.data());
+    argv.push_back(nullptr);
+
+    const int ret{posix_spawnp(&pid, argv[0], &actions, nullptr, argv.data(), environ)};
+    posix_spawn_file_actions_destroy(&actions);
+    close(fds[1]);
+
+    if (ret)
+    {
+        close(fds[0]);
+        errors = "Can't run " + args[0] + ".\n";
+        status = W_EXITCODE(127, 0);
+
+        return false;
+    }
+
+    fd = fds[0];
+
+    return true;
+}
+
+/**
+ * Read whatever the process has written to standard error.
+ *
+ * @return true if the pipe is still open, false at end of file.
+ */
+bool Job::read(void)
+{
+    char buffer[4096];
+    const ssize_t count{::read(fd, buffer, sizeof(buffer))};
+    if (count > 0)
+    {
+        errors.append(buffer, count);
+
+        return true;
+    }
+
+    close(fd);
+    fd = -1;
+
+    return false;
+}
+
+/**
+ * Check if the process has finished, without blocking. A process that
+ * failed to start is treated as finished.
+ *
+ * @return true if the process has finished, false otherwise.
+ */
+bool Job::wait(void)
+{
+    if (pid < 0)
+        return true;
+
+    if (waitpid(pid, &status, WNOHANG) != pid)
+        return false;
+
+    pid = -1;
+
+    return true;
+}
+
+/**
+ * Rename the image written by a successful process to the output file. Any
+ * partial image left by a failed process is removed.
+ *
+ * @return true if the process succeeded and the image is in place, false
+ * otherwise.
+ */
+bool Job::commit(void)
+{
+    const std::string tempFile{PngWriter::getTempFilename(outputFile)};
+    std::error_code ec{};
+    if (!isSuccess())
+    {
+        std::filesystem::remove(tempFile, ec);
+
+        return false;
+    }
+
+    std::filesystem::rename(tempFile, outputFile, ec);
+    if (!ec)
+        return true;
+
+    errors = "Can't rename the image to " + outputFile + ".\n";
+    status = W_EXITCODE(1, 0);
+    std::filesystem::remove(tempFile, ec);
+
+    return false;
+}
+
+/**
+ * Describe how the process finished.
+ *
+ * @return the description.
+ */
+std::string Job::getStatusString(void) const
+{
+    if (WIFSIGNALED(status))
+        return "killed by signal " + std::to_string(WTERMSIG(status));
+
+    return "exit status " + std::to_string(WEXITSTATUS(status));
+}
+
+
+/**
+ * @section main code.
+ *
+ */
+
+/**
+ * Run a set of jobs using a bounded pool of processes, retrying any that
+ * fail.
+ *
+ * @param  pending - jobs to run.
+ * @param  jobs - maximum number of processes.
+ * @param  retries - number of times a failed job is retried.
+ * @return number of jobs that failed.
+ */
+static int runPool(std::deque<Job> & pending, size_t jobs, int retries)
+{
+    std::vector<Job> running{};
+    int failures{};
+    while ((!pending.empty()) || (!running.empty()))
+    {
+        // Start as many jobs as allowed.
+        while ((running.size() < jobs) && (!pending.empty()))
+        {
+            running.push_back(pending.front());
+            pending.pop_front();
+            running.back().start();
+        }
+
+        // Collect standard error from the running jobs.
+        std::vector<pollfd> fds{};
+        for (const auto & job : running)
+            if (job.getFd() >= 0)
+                fds.push_back(pollfd{job.getFd(), POLLIN, 0});
+
+        if (poll(fds.data(), fds.size(), fds.empty() ? 10 : 100) > 0)
+            for (auto & job : running)
+                for (const auto & p : fds)
+                    if ((p.fd == job.getFd()) && (p.revents))
+                        job.read();
+
+        // Retire the finished jobs, retrying failures.
+        for (auto it{running.begin()}; it != running.end(); )
+        {
+            if ((it->getFd() >= 0) || (!it->wait()))
+            {
+                ++it;
+                continue;
+            }
+
+            if (it->commit())
+            {
+                if ((Cache::isEnabled()) && (!it->getKey().empty()))
+                    Cache::store(it->getKey(), it->getOutputFilename());
+
+                if (it->getRecord())
+                    it->getRecord()->update(it->getCard().getName(), it->getKey());
+            }
+            else
+            {
+                if (it->getAttempts() <= retries)
+                    pending.push_back(*it);
+                else
+                {
+                    ++failures;
+                    std::cerr << "Failed to draw " << it->getCard().getName() << ".png (" << it->getStatusString() << "):\n" << it->getErrors();
+
+                    if (it->getRecord())
+                        it->getRecord()->erase(it->getCard().getName());
+                }
+            }
+
+            it = running.erase(it);
+        }
+    }
+
+    return failures;
+}
+
+/**
+ * Run the 'convert' command for every card using a bounded pool of
+ * processes, retrying any that fail. Any shared layers needed are drawn
+ * first and removed afterwards. The cards of every deck in the batch file
+ * share the pool. With --incremental only the cards whose key differs from
+ * the record of their deck are drawn, and with --shard only the cards of
+ * this shard.
+ *
+ * @param  argc - command line argument count.
+ * @param  argv - command line argument vector.
+ * @return error value or 0 if no errors.
+ */
+int runJobs(int argc, char *argv[])
+{
+    std::vector<RenderContext> contexts{};
+    if (Config::getDecks(argc, argv, contexts))
+        return 1;
+
+    const size_t jobs{size_t(Config::getJobs())};
+    const int retries{Config::getRetries()};
+
+//- Make the directories and generate the refresh scripts.
+    for (const auto & context : contexts)
+        if (genOutputDirectory(context, argc, argv, ""))
+            return 1;
+
+//- Build the argument vectors for all the playing cards.
+    std::vector<Deck> decks{};
+    for (const auto & context : contexts)
+        decks.push_back(layoutDeck(context));
+    Shard::select(decks);
+
+    std::deque<Job> pending{};
+    std::deque<Job> layerJobs{};
+    std::vector<std::string> layerFiles{};
+    std::deque<Record> records{};
+    size_t cards{};
+    for (size_t i{}; i < contexts.size(); ++i)
+    {
+        const RenderContext & context{contexts[i]};
+        const auto outputDirectory{context.getOutputDirectory()};
+        const Deck & deck{decks[i]};
+        Record & record{records.emplace_back(outputDirectory)};
+        Deck needed{};
+        for (const auto & card : deck)
+        {
+            const std::string outputFile{outputDirectory + card.getName() + ".png"};
+            const std::string key{Cache::getKey(context, card, "convert")};
+            if ((Record::isIncremental()) && (record.check(card.getName(), key, outputFile)))
+                continue;
+
+            if ((Cache::isEnabled()) && (Cache::fetch(key, outputFile)))
+            {
+                record.update(card.getName(), key);
+
+                continue;
+            }
+
+            pending.emplace_back(context, card, key, &record);
+            needed.push_back(card);
+        }
+        cards += deck.size();
+
+        // The shared layers needed by the remaining cards.
+        for (const auto layer : getLayers(needed))
+        {
+            layerJobs.emplace_back(context, *layer, "");
+            layerFiles.push_back(outputDirectory + layer->getName() + ".png");
+        }
+    }
+
+//- Draw the shared layers, then run the jobs.
+    int failures{runPool(layerJobs, jobs, retries)};
+    failures += runPool(pending, jobs, retries);
+
+    std::error_code ec{};
+    for (const auto & layerFile : layerFiles)
+        std::filesystem::remove(layerFile, ec);
+
+    int errors{};
+    for (auto & record : records)
+        errors += record.save();
+
+    if (failures)
+    {
+        std::cerr << failures << " of " << cards + layerFiles.size() << " cards failed.\n";
+
+        return 1;
+    }
+
+    if (Cache::isEnabled())
+        std::cout << Cache::getHits() << " of " << cards << " cards reused from the cache.\n";
+
+    if (Record::isIncremental())
+        std::cout << Record::getUnchanged() << " of " << cards << " cards unchanged since they were last drawn.\n";
+
+    for (const auto & context : contexts)
+        std::cout << "Output created in " << context.getOutputDirectory() << "\n";
+
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,779 @@
+/**
+ * @file    render.cpp
+ * @author  Phil Lockett <phillockett65@gmail.com>
+ * @version 1.0
+ *
+ * @section LICENSE
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details at
+ * https://www.gnu.org/copyleft/gpl.html
+ *
+ * @section DESCRIPTION
+ *
+ * 'cardgen' is a playing card image generator.
+ *
+ * Native card renderer, an alternative to the generated 'convert' script.
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <algorithm>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <functional>
+#include <fstream>
+#include <sstream>
+
+#include "cardgen.h"
+#include "Canvas.h"
+#include "Cache.h"
+#include "Record.h"
+#include "Shard.h"
+#include "Sprites.h"
+#include "Quantize.h"
+#include "Hash.h"
+#include "PngWriter.h"
+#include "Configuration.h"
+#include "RenderContext.h"
+#include "Pool.h"
+#include "BoundedQueue.h"
+
+
+/**
+ * @section Internal constants and variables.
+ *
+ */
+
+struct Image
+{
+    std::once_flag loaded;
+    Canvas canvas;
+};
+static std::mutex mutex{};
+static std::map<std::string, Image> images{};
+
+struct Layer
+{
+    std::once_flag drawn;
+    Canvas canvas;
+    int errors;
+};
+using Layers = std::map<const Card *, Layer>;
+
+/**
+ * The buffers each thread reuses from card to card, so that once a thread
+ * has drawn a card no more memory is needed for the cards that follow.
+ */
+struct Arena
+{
+    Canvas canvas;
+    Canvas sprite;
+    std::shared_ptr<const Canvas> cached;
+    std::vector<float> temp;
+};
+static thread_local Arena arena{};
+
+/**
+ * A drawn card on its way to the encode stage.
+ */
+struct Output
+{
+    Canvas canvas;
+    std::string fileName;
+    std::string key;
+    int errors;
+    Quantize::Palette palette;
+    std::vector<uint8_t> indices;
+    PngWriter::Level level;
+    Record * record;
+    std::string name;
+};
+static std::mutex spareMutex{};
+static std::vector<Canvas> spares{};
+static std::atomic<long> encodedCards{};
+static std::atomic<long> encodedBytes{};
+static std::atomic<long> encodeTime{};
+
+/**
+ * A deck being rendered, with the shared layers drawn for it.
+ */
+struct DeckState
+{
+    const RenderContext * context;
+    Deck deck;
+    Canvas blank;
+    Layers layers;
+    std::atomic<size_t> remaining;
+    std::mutex mutex;
+    Quantize::Histogram histogram;
+    Quantize::Palette palette;
+    std::string paletteKey;
+    std::unique_ptr<Record> record;
+};
+
+static const int gap{16};
+
+
+/**
+ * @section main code.
+ *
+ */
+
+/**
+ * Generate the initial blank card used as a template for each card. This
+ * mirrors genStartString() in the script generator.
+ *
+ * @param  context - context of the deck.
+ * @return the blank card.
+ */
+static Canvas genBlank(const RenderContext & context)
+{
+    const auto cardWidthPx{context.getCardWidthPx()};
+    const auto cardHeightPx{context.getCardHeightPx()};
+    const auto cardBorderPx{context.getCardBorderPx()};
+    const auto cardColour{context.getCardColour()};
+    const auto mpc{context.isMpc()};
+    const auto radius{context.getRadius()};
+    const auto borderOffset{context.getBorderOffset()};
+    const auto outlineWidth{context.getOutlineWidth()};
+    const auto outlineHeight{context.getOutlineHeight()};
+    const auto strokeWidth{context.getStrokeWidth()};
+
+    Canvas blank{cardWidthPx + (2 * cardBorderPx), cardHeightPx + (2 * cardBorderPx)};
+
+    Canvas::Pixel fill{};
+    if (!Canvas::parseColour(cardColour, fill))
+    {
+        std::cerr << "Unsupported colour \"" << cardColour << "\", using white.\n";
+        Canvas::parseColour("white", fill);
+    }
+
+    Canvas::Pixel stroke{};
+    Canvas::parseColour("black", stroke);
+
+    if (mpc)
+        blank.rectangle(borderOffset, borderOffset, outlineWidth + (2 * cardBorderPx), outlineHeight + (2 * cardBorderPx), 0, fill, stroke, 0);
+    else
+        blank.rectangle(borderOffset, borderOffset, outlineWidth, outlineHeight, radius, fill, stroke, strokeWidth);
+
+    return blank;
+}
+
+/**
+ * Get the decoded image for a file, decoding it only on first use. The
+ * images are shared by all the decks being rendered, so different images
+ * can be decoded at the same time but each is only decoded once.
+ *
+ * @param  fileName - name of image file.
+ * @return the decoded image, or nullptr if it could not be decoded.
+ */
+static const Canvas * getImage(const std::string & fileName)
+{
+    Image * image{};
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        image = &images[fileName];
+    }
+
+    std::call_once(image->loaded, [&]() {
+        if (!image->canvas.load(fileName))
+            std::cerr << "Can't read image file " << fileName << "\n";
+    });
+
+    return image->canvas.isEmpty() ? nullptr : &image->canvas;
+}
+
+/**
+ * Get a component image scaled to the size it is drawn at and rotated if
+ * required. Unless the sprite cache is disabled, the sprite is shared with
+ * every card that draws the same image at the same size.
+ *
+ * @param  image - decoded component image.
+ * @param  op - operation that draws the image.
+ * @param  filter - filter used to resize the image.
+ * @return the sprite, which remains valid until the thread's next call.
+ */
+static const Canvas & getSprite(const Canvas & image, const Op & op, Resample::Filter filter)
+{
+    if (!Sprites::isEnabled())
+    {
+        image.resize(op.getW(), op.getH(), arena.sprite, arena.temp, filter);
+        if (op.isRotated())
+            arena.sprite.rotate180();
+
+        return arena.sprite;
+    }
+
+    const Sprites::Key key{op.getFileName(), op.getW(), op.getH(), op.isRotated(), filter};
+    arena.cached = Sprites::find(key);
+    if (!arena.cached)
+    {
+        auto sprite{std::make_shared<Canvas>()};
+        image.resize(op.getW(), op.getH(), *sprite, arena.temp, filter);
+        if (op.isRotated())
+            sprite->rotate180();
+        arena.cached = Sprites::insert(key, std::move(sprite));
+    }
+
+    return *arena.cached;
+}
+
+/**
+ * Apply the operations of a card to a canvas.
+ *
+ * @param  canvas - canvas to draw on.
+ * @param  card - card to draw.
+ * @param  filter - filter used to resize the component images.
+ * @return number of component images that could not be drawn.
+ */
+static int drawOps(Canvas & canvas, const Card & card, Resample::Filter filter)
+{
+    int errors{};
+    for (const auto & op : card)
+    {
+        if (op.isRotate())
+            canvas.rotate180();
+        else
+        if (op.isImage())
+        {
+            const Canvas * image{getImage(op.getFileName())};
+            if (image)
+                canvas.over(getSprite(*image, op, filter), op.getX(), op.getY());
+            else
+                ++errors;
+        }
+    }
+
+    return errors;
+}
+
+/**
+ * Get the canvas for a shared layer, drawing it only on first use. The
+ * table of layers is filled in before the cards are drawn, so only the
+ * drawing of each layer needs to be guarded.
+ *
+ * @param  state - deck being rendered.
+ * @param  layer - layer to draw.
+ * @return the drawn layer.
+ */
+static const Layer & getLayer(DeckState & state, const Card & layer)
+{
+    Layer & output{state.layers.at(&layer)};
+    std::call_once(output.drawn, [&]() {
+        output.canvas = state.blank;
+        output.errors = drawOps(output.canvas, layer, state.context->getFilter());
+    });
+
+    return output;
+}
+
+/**
+ * Get a canvas for a card, reusing one returned by the encode stage if
+ * there is one.
+ *
+ * @return the canvas.
+ */
+static Canvas getSpare(void)
+{
+    std::lock_guard<std::mutex> lock{spareMutex};
+    if (spares.empty())
+        return Canvas{};
+
+    Canvas canvas{std::move(spares.back())};
+    spares.pop_back();
+
+    return canvas;
+}
+
+/**
+ * Return a canvas for reuse by the compose stage.
+ *
+ * @param  canvas - canvas no longer needed.
+ */
+static void putSpare(Canvas && canvas)
+{
+    std::lock_guard<std::mutex> lock{spareMutex};
+    spares.push_back(std::move(canvas));
+}
+
+/**
+ * Decode stage. Decode the component images of the cards in the order they
+ * will be drawn, so the compose stage rarely has to wait for a file.
+ *
+ * @param  cards - cards in the order they will be drawn.
+ */
+static void decodeImages(const std::vector<const Card *> & cards)
+{
+    for (const auto card : cards)
+    {
+        if (card->getBase())
+            for (const auto & op : *card->getBase())
+                if (op.isImage())
+                    getImage(op.getFileName());
+
+        for (const auto & op : *card)
+            if (op.isImage())
+                getImage(op.getFileName());
+    }
+}
+
+/**
+ * Get the name identifying the renderer and the settings that change its
+ * output, for the cache key. The default filter keeps the original name so
+ * that existing cache entries are still used.
+ *
+ * @param  context - context of the deck.
+ * @return the name of the renderer.
+ */
+static std::string getRendererName(const RenderContext & context)
+{
+    std::string name{"native"};
+    if (context.getFilter() != _filter)
+        name += "-" + Resample::getFilterName(context.getFilter());
+
+    if (context.getColours())
+    {
+        name += "-" + std::to_string(context.getColours()) + "-" + Quantize::getDitherName(context.getDither());
+        if (context.isSharedPalette())
+            name += "-shared";
+    }
+
+    return name;
+}
+
+/**
+ * Draw a single card by applying its operations to a copy of its shared
+ * layer, or of the blank card template if it doesn't have one.
+ *
+ * @param  state - deck being rendered.
+ * @param  card - card to draw.
+ * @param  canvas - set to the drawn card.
+ * @return number of component images that could not be drawn.
+ */
+static int drawCard(DeckState & state, const Card & card, Canvas & canvas)
+{
+    const Layer * layer{card.getBase() ? &getLayer(state, *card.getBase()) : nullptr};
+    canvas = layer ? layer->canvas : state.blank;
+
+    return (layer ? layer->errors : 0) + drawOps(canvas, card, state.context->getFilter());
+}
+
+/**
+ * Count the colours of a card towards the palette shared by its deck.
+ *
+ * @param  state - deck being rendered.
+ * @param  card - card to count.
+ */
+static void countColours(DeckState & state, const Card & card)
+{
+    Canvas & canvas{arena.canvas};
+    drawCard(state, card, canvas);
+
+    Quantize::Histogram histogram{};
+    Quantize::addHistogram(histogram, canvas);
+
+    std::lock_guard<std::mutex> lock{state.mutex};
+    Quantize::addHistogram(state.histogram, histogram);
+}
+
+/**
+ * Compose stage. Draw a single card, reduce it to a palette if required,
+ * and pass it on to the encode stage. The key of a card whose deck shares a
+ * palette is only known once the palette has been chosen, so such a card
+ * is checked against the record of the deck here.
+ *
+ * @param  state - deck being rendered.
+ * @param  card - card to render.
+ * @param  key - key of the card, if already generated.
+ * @param  queue - queue to the encode stage.
+ * @return error value or 0 if no errors.
+ */
+static int composeCard(DeckState & state, const Card & card, const std::string & key, BoundedQueue<Output> & queue)
+{
+    const RenderContext & context{*state.context};
+    Output output{{}, context.getOutputDirectory() + card.getName() + ".png", key, 0, {}, {}, context.getPngLevel(), state.record.get(), card.getName()};
+    if (output.key.empty())
+    {
+        output.key = Cache::getKey(context, card, getRendererName(context) + state.paletteKey);
+        if ((Record::isIncremental()) && (output.record->check(output.name, output.key, output.fileName)))
+            return 0;
+    }
+
+    if ((Cache::isEnabled()) && (Cache::fetch(output.key, output.fileName)))
+    {
+        output.record->update(output.name, output.key);
+
+        return 0;
+    }
+
+    output.canvas = getSpare();
+    output.errors = drawCard(state, card, output.canvas);
+
+    if (context.getColours())
+    {
+        if (context.isSharedPalette())
+            output.palette = state.palette;
+        else
+        {
+            Quantize::Histogram histogram{};
+            Quantize::addHistogram(histogram, output.canvas);
+            output.palette = Quantize::genPalette(histogram, context.getColours());
+        }
+        Quantize::map(output.canvas, output.palette, context.getDither(), output.indices);
+    }
+
+    const int errors{output.errors};
+    queue.push(std::move(output));
+
+    return errors;
+}
+
+/**
+ * Encode stage. Write a drawn card to its .png file, add it to the cache
+ * and record its key.
+ *
+ * @param  output - drawn card.
+ * @return error value or 0 if no errors.
+ */
+static int encodeCard(const Output & output)
+{
+    const auto start{std::chrono::steady_clock::now()};
+    size_t bytes{};
+    const bool saved{output.palette.empty() ?
+        PngWriter::write(output.fileName, output.canvas, output.level, bytes) :
+        PngWriter::write(output.fileName, output.canvas, output.palette, output.indices, output.level, bytes)};
+    const long ns{long(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count())};
+    if (!saved)
+    {
+        std::cerr << "Can't write image file " << output.fileName << "\n";
+        output.record->erase(output.name);
+
+        return 1;
+    }
+
+    ++encodedCards;
+    encodedBytes += long(bytes);
+    encodeTime += ns;
+    if (Config::isDebug())
+    {
+        std::ostringstream line{};
+        line << output.fileName << ": " << bytes << " bytes encoded in " << ns / 1000 << " us.\n";
+        std::cout << line.str();
+    }
+
+    if ((!output.errors) && (Cache::isEnabled()))
+        Cache::store(output.key, output.fileName);
+
+    // A card missing a component image is drawn again by the next run.
+    if (output.errors)
+        output.record->erase(output.name);
+    else
+        output.record->update(output.name, output.key);
+
+    return 0;
+}
+
+
+/**
+ * Render the deck, or every deck in the batch file, directly to .png files.
+ * The work is split into pipeline stages so that decoding and encoding
+ * overlap the drawing of other cards: a thread decodes the component images
+ * ahead of use, the cards of every deck are drawn by a pool of threads, the
+ * most expensive first, and a further set of threads encodes and writes the
+ * drawn cards. The queue to the encoders caps the number of drawn cards held
+ * in memory. With --incremental only the cards whose key differs from the
+ * record of their deck are drawn, and with --shard only the cards of this
+ * shard.
+ *
+ * @param  argc - command line argument count.
+ * @param  argv - command line argument vector.
+ * @return error value or 0 if no errors.
+ */
+int renderCards(int argc, char *argv[])
+{
+    std::vector<RenderContext> decks{};
+    if (Config::getDecks(argc, argv, decks))
+        return 1;
+
+//- Make the directories and generate the refresh scripts.
+    for (const auto & context : decks)
+        if (genOutputDirectory(context, argc, argv, ""))
+            return 1;
+
+//- Lay out every deck and list the cards to be drawn.
+    std::vector<DeckState> states(decks.size());
+    std::vector<long> deckCosts{};
+    for (size_t i{}; i < decks.size(); ++i)
+    {
+        DeckState & state{states[i]};
+        state.context = &decks[i];
+        state.deck = layoutDeck(decks[i]);
+        for (const auto & card : state.deck)
+            deckCosts.push_back(card.estimateCost());
+    }
+    const auto selected{Shard::select(deckCosts)};
+
+    std::vector<std::pair<DeckState *, const Card *>> cards{};
+    std::vector<std::string> keys{};
+    std::vector<long> costs{};
+    size_t total{};
+    size_t index{};
+    for (auto & state : states)
+    {
+        const RenderContext & context{*state.context};
+        state.blank = genBlank(context);
+        for (const auto layer : getLayers(state.deck))
+            state.layers[layer];
+
+        state.record = std::make_unique<Record>(context.getOutputDirectory());
+        for (const auto & card : state.deck)
+        {
+            if (!selected[index++])
+                continue;
+
+            ++total;
+            std::string key{};
+            if ((Record::isIncremental()) && (!context.isSharedPalette()))
+            {
+                key = Cache::getKey(context, card, getRendererName(context));
+                if (state.record->check(card.getName(), key, context.getOutputDirectory() + card.getName() + ".png"))
+                    continue;
+            }
+
+            cards.emplace_back(&state, &card);
+            keys.push_back(key);
+            costs.push_back(card.estimateCost());
+            ++state.remaining;
+        }
+    }
+
+//- Start the decode and encode stages.
+    std::vector<const Card *> order{};
+    for (const auto & card : cards)
+        order.push_back(card.second);
+    std::stable_sort(order.begin(), order.end(), [](const Card * a, const Card * b) { return a->estimateCost() > b->estimateCost(); });
+    std::thread decoder{decodeImages, std::cref(order)};
+
+    const size_t threads{Pool::getThreadCount()};
+    BoundedQueue<Output> queue{threads * 2};
+    std::atomic<int> failures{};
+    std::vector<std::thread> encoders{};
+    for (size_t i{}; i < std::max<size_t>(threads / 2, 1); ++i)
+        encoders.emplace_back([&]() {
+            Output output{};
+            while (queue.pop(output))
+            {
+                failures += encodeCard(output);
+                putSpare(std::move(output.canvas));
+            }
+        });
+
+//- Choose the palette of each deck whose cards share one, from a first
+//  pass over every card of the deck, including those of other shards, so
+//  that every shard chooses the same palette.
+    std::vector<std::pair<DeckState *, const Card *>> counted{};
+    std::vector<long> countCosts{};
+    for (auto & state : states)
+        if ((state.context->isSharedPalette()) && (state.remaining))
+            for (const auto & card : state.deck)
+            {
+                counted.emplace_back(&state, &card);
+                countCosts.push_back(card.estimateCost());
+            }
+
+    Pool::run(countCosts, [&](size_t i) {
+        countColours(*counted[i].first, *counted[i].second);
+
+        return 0;
+    });
+
+    for (auto & state : states)
+        if (state.context->isSharedPalette())
+        {
+            state.palette = Quantize::genPalette(state.histogram, state.context->getColours());
+            state.histogram.clear();
+            state.paletteKey = "-" + Hash{}.update(state.palette.data(), state.palette.size() * 4).digest();
+        }
+
+//- Draw all the playing cards.
+    int errors{Pool::run(costs, [&](size_t i) {
+        DeckState & state{*cards[i].first};
+        const int result{composeCard(state, *cards[i].second, keys[i], queue)};
+
+        // Free the shared layers of a deck once all its cards are drawn.
+        if (--state.remaining == 0)
+            state.layers.clear();
+
+        return result;
+    })};
+
+    queue.close();
+    for (auto & encoder : encoders)
+        encoder.join();
+    decoder.join();
+    errors += failures;
+
+    if (Cache::isEnabled())
+        std::cout << Cache::getHits() << " of " << Cache::getHits() + Cache::getMisses() << " cards reused from the cache.\n";
+
+    for (auto & state : states)
+        errors += state.record->save();
+
+    if (Record::isIncremental())
+        std::cout << Record::getUnchanged() << " of " << total << " cards unchanged since they were last drawn.\n";
+
+    if (encodedCards)
+        std::cout << encodedCards << " cards encoded, " << encodedBytes / encodedCards << " bytes and "
+            << encodeTime / encodedCards / 1000 << " us per card.\n";
+
+    if (Config::isDebug())
+        std::cout << Sprites::getHits() << " of " << Sprites::getHits() + Sprites::getMisses() << " sprites reused.\n";
+    Sprites::clear();
+
+    for (const auto & context : decks)
+        std::cout << "Output created in " << context.getOutputDirectory() << "\n";
+
+    return errors ? 1 : 0;
+}
+
+
+/**
+ * Write the settings used for each row and column of the contact sheets.
+ *
+ * @param  fileName - name of file to write.
+ * @param  sweeps - the settings being varied and their values.
+ * @return error value or 0 if no errors.
+ */
+static int writeLegend(const std::string & fileName, const std::vector<Sweep> & sweeps)
+{
+    std::ofstream file{fileName.c_str()};
+    if (!file)
+    {
+        std::cerr << "Can't open output file " << fileName << " - aborting!\n";
+
+        return 1;
+    }
+
+    const Sweep & last{sweeps.back()};
+    for (size_t column{}; column < last.values.size(); ++column)
+        file << "Column " << column + 1 << ": " << last.name << "=" << last.values[column] << "\n";
+
+    size_t rows{1};
+    for (size_t i{}; i + 1 < sweeps.size(); ++i)
+        rows *= sweeps[i].values.size();
+
+    for (size_t row{}; (sweeps.size() > 1) && (row < rows); ++row)
+    {
+        std::string settings{};
+        size_t n{row};
+        for (size_t i{sweeps.size() - 1}; i-- > 0; )
+        {
+            const auto & values{sweeps[i].values};
+            std::ostringstream setting{};
+            setting << " " << sweeps[i].name << "=" << values[n % values.size()];
+            settings = setting.str() + settings;
+            n /= values.size();
+        }
+        file << "Row " << row + 1 << ":" << settings << "\n";
+    }
+
+    return 0;
+}
+
+
+/**
+ * Render a contact sheet for each card, showing the card drawn with every
+ * combination of the ranges given with --sweep. The columns of each sheet
+ * take the values of the last setting swept and the rows the combinations
+ * of the others. The component images are decoded once for every
+ * combination.
+ *
+ * @param  argc - command line argument count.
+ * @param  argv - command line argument vector.
+ * @return error value or 0 if no errors.
+ */
+int sweepCards(int argc, char *argv[])
+{
+    if (Config::isBatch())
+    {
+        std::cerr << "--sweep can't be used with --batch.\n";
+
+        return 1;
+    }
+
+    std::vector<Sweep> sweeps{};
+    std::vector<RenderContext> contexts{};
+    if (Config::getSweep(argc, argv, sweeps, contexts))
+        return 1;
+
+//- Make the directories and generate the refresh script.
+    const auto outputDirectory{contexts.front().getOutputDirectory()};
+    if (genOutputDirectory(contexts.front(), argc, argv, ""))
+        return 1;
+
+    if (writeLegend(outputDirectory + "sweep.txt", sweeps))
+        return 1;
+
+//- Lay out the deck for each combination. Only the % settings are swept,
+//  so every combination has the same blank card.
+    std::vector<Deck> decks{};
+    for (const auto & context : contexts)
+        decks.push_back(layoutDeck(context));
+
+    const Canvas blank{genBlank(contexts.front())};
+    const int columns{int(sweeps.back().values.size())};
+    const int rows{int(decks.size()) / columns};
+    const int cellWidth{blank.getWidth() + gap};
+    const int cellHeight{blank.getHeight() + gap};
+
+//- Draw the contact sheet of each card.
+    std::vector<long> costs{};
+    for (const auto & card : decks.front())
+        costs.push_back(card.estimateCost() * long(decks.size()));
+
+    const int errors{Pool::run(costs, [&](size_t c) {
+        Canvas sheet{(columns * cellWidth) + gap, (rows * cellHeight) + gap};
+        int failures{};
+        for (size_t i{}; i < decks.size(); ++i)
+        {
+            const Card & card{decks[i][c]};
+            Canvas & canvas{arena.canvas};
+            canvas = blank;
+            if (card.getBase())
+                failures += drawOps(canvas, *card.getBase(), contexts[i].getFilter());
+            failures += drawOps(canvas, card, contexts[i].getFilter());
+
+            sheet.over(canvas, gap + (int(i) % columns) * cellWidth, gap + (int(i) / columns) * cellHeight);
+        }
+
+        const std::string fileName{outputDirectory + decks.front()[c].getName() + ".png"};
+        size_t bytes{};
+        if (!PngWriter::write(fileName, sheet, contexts.front().getPngLevel(), bytes))
+        {
+            std::cerr << "Can't write image file " << fileName << "\n";
+            ++failures;
+        }
+
+        return failures;
+    })};
+
+    Sprites::clear();
+
+    std::cout << decks.size() << " combinations drawn on each card.\n";
+    std::cout << "Output created in " << outputDirectory << "\n";
+
+    return errors ? 1 : 0;
+}